@@ -39,6 +39,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "er-coap-observe.h"
+#include "lib/tlist.h"
 
 #define DEBUG 0
 #if DEBUG
@@ -54,7 +55,7 @@
 
 /*---------------------------------------------------------------------------*/
 MEMB(observers_memb, coap_observer_t, COAP_MAX_OBSERVERS);
-LIST(observers_list);
+DLIST(observers_list);
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -76,9 +77,9 @@ coap_add_observer(uip_ipaddr_t *addr, uint16_t port, const uint8_t *token,
     o->last_mid = 0;
 
     PRINTF("Adding observer (%u/%u) for /%s [0x%02X%02X]\n",
-           list_length(observers_list) + 1, COAP_MAX_OBSERVERS,
+           tlist_length(observers_list) + 1, COAP_MAX_OBSERVERS,
            o->url, o->token[0], o->token[1]);
-    list_add(observers_list, o);
+    tlist_add(observers_list, o);
   }
 
   return o;
@@ -93,7 +94,7 @@ coap_remove_observer(coap_observer_t *o)
          o->token[1]);
 
   memb_free(&observers_memb, o);
-  list_remove(observers_list, o);
+  tlist_remove(observers_list, o);
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -102,7 +103,7 @@ coap_remove_observer_by_client(uip_ipaddr_t *addr, uint16_t port)
   int removed = 0;
   coap_observer_t *obs = NULL;
 
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
+  for(obs = (coap_observer_t *)tlist_head(observers_list); obs;
       obs = obs->next) {
     PRINTF("Remove check client ");
     PRINT6ADDR(addr);
@@ -122,7 +123,7 @@ coap_remove_observer_by_token(uip_ipaddr_t *addr, uint16_t port,
   int removed = 0;
   coap_observer_t *obs = NULL;
 
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
+  for(obs = (coap_observer_t *)tlist_head(observers_list); obs;
       obs = obs->next) {
     PRINTF("Remove check Token 0x%02X%02X\n", token[0], token[1]);
     if(uip_ipaddr_cmp(&obs->addr, addr) && obs->port == port
@@ -142,7 +143,7 @@ coap_remove_observer_by_uri(uip_ipaddr_t *addr, uint16_t port,
   int removed = 0;
   coap_observer_t *obs = NULL;
 
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
+  for(obs = (coap_observer_t *)tlist_head(observers_list); obs;
       obs = obs->next) {
     PRINTF("Remove check URL %p\n", uri);
     if((addr == NULL
@@ -161,7 +162,7 @@ coap_remove_observer_by_mid(uip_ipaddr_t *addr, uint16_t port, uint16_t mid)
   int removed = 0;
   coap_observer_t *obs = NULL;
 
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
+  for(obs = (coap_observer_t *)tlist_head(observers_list); obs;
       obs = obs->next) {
     PRINTF("Remove check MID %u\n", mid);
     if(uip_ipaddr_cmp(&obs->addr, addr) && obs->port == port
@@ -186,7 +187,7 @@ coap_notify_observers(resource_t *resource)
   PRINTF("Observe: Notification from %s\n", resource->url);
 
   /* iterate over observers */
-  for(obs = (coap_observer_t *)list_head(observers_list); obs;
+  for(obs = (coap_observer_t *)tlist_head(observers_list); obs;
       obs = obs->next) {
     if(obs->url == resource->url) {     /* using RESOURCE url pointer as handle */
       coap_transaction_t *transaction = NULL;
@@ -253,7 +254,7 @@ coap_observe_handler(resource_t *resource, void *request, void *response)
            * coap_set_payload(coap_res,
            *                  content,
            *                  snprintf(content, sizeof(content), "Added %u/%u",
-           *                           list_length(observers_list),
+           *                           tlist_length(observers_list),
            *                           COAP_MAX_OBSERVERS));
            */
         } else {
@@ -52,7 +52,8 @@ typedef struct coap_observable {
 } coap_observable_t;
 
 typedef struct coap_observer {
-  struct coap_observer *next;   /* for LIST */
+  struct coap_observer *next;   /* for DLIST */
+  struct coap_observer *prev;
 
   const char *url;
   uip_ipaddr_t addr;
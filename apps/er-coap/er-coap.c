@@ -980,79 +980,122 @@ coap_set_metrics(void *packet, const uint8_t *metric, size_t metric_len)
 }
 
 /** 
- * Function to get metric values from packet
+ * Function to find metric option in serialized message. Options are only
+ * skipped, message is neither copied nor parsed as whole.
+ *
+ * \return length of option or 0 if message carries no metric option
  */
-struct k_val coap_get_k_val(uint8_t *data, uint16_t data_len)
+size_t
+coap_find_metric_option(const uint8_t *data, uint16_t data_len,
+                        const uint8_t **metric)
 {
-  static coap_packet_t message[1];
-  uint8_t buffer[REST_MAX_CHUNK_SIZE];
-  memcpy(buffer, data, data_len);
-  uint8_t ii;
-  struct k_val values;
-  uint8_t *p;
-  p=&values;
-  for(ii=1; ii<10; ii++){
-    *p=0;
-    p=p+1;
+  const uint8_t *current_option = data + COAP_HEADER_LEN;
+  const uint8_t *end = data + data_len;
+  unsigned int option_number = 0;
+  unsigned int option_delta;
+  unsigned int option_length;
+
+  if(data_len < COAP_HEADER_LEN
+     || ((COAP_HEADER_VERSION_MASK & data[0]) >> COAP_HEADER_VERSION_POSITION) != 1) {
+    return 0;
   }
-  PRINTF("coap_get_val data with len: %d\n", data_len);
-  uint8_t i=0;
-  for (i = 0; i < data_len; i++)
-  {
-    unsigned char c = ((char*)data)[i] ;
-    PRINTF ("%02x ", c) ;
-  }
-  PRINTF("\n");
-  erbium_status_code = NO_ERROR;
-  erbium_status_code = coap_parse_message(message, buffer, data_len);
-    if(erbium_status_code == NO_ERROR) {
-      if(!IS_OPTION(message, COAP_OPTION_METRIC)) {
-        printf("No metric option!\n");
-        return values;
+  current_option += (COAP_HEADER_TOKEN_LEN_MASK & data[0])
+    >> COAP_HEADER_TOKEN_LEN_POSITION;
+
+  while(current_option < end) {
+    /* payload marker, no more options */
+    if((current_option[0] & 0xF0) == 0xF0) {
+      return 0;
+    }
+
+    option_delta = current_option[0] >> 4;
+    option_length = current_option[0] & 0x0F;
+    ++current_option;
+
+    unsigned int *x = &option_delta;
+
+    do {
+      if(*x == 13) {
+        if(current_option >= end) {
+          return 0;
+        }
+        *x += current_option[0];
+        ++current_option;
+      } else if(*x == 14) {
+        if(current_option + 1 >= end) {
+          return 0;
+        }
+        *x += 255 + (current_option[0] << 8) + current_option[1];
+        current_option += 2;
+      } else if(*x == 15) {
+        return 0;
       }
-      return coap_metrics_deserialization(&message->metric);
+    } while(x != &option_length && (x = &option_length));
+
+    option_number += option_delta;
+    /* options are sorted by number, metric option can not follow */
+    if(option_number > COAP_OPTION_METRIC || current_option + option_length > end) {
+      return 0;
+    }
+    if(option_number == COAP_OPTION_METRIC) {
+      *metric = current_option;
+      return MIN(COAP_METRIC_LEN, option_length);
+    }
+    current_option += option_length;
   }
-  else
-    printf("Erbium error!!!\n");
-    return values;
+  return 0;
+}
 
+/** 
+ * Function to get metric values from packet
+ */
+struct k_val coap_get_k_val(const uint8_t *data, uint16_t data_len)
+{
+  const uint8_t *metric;
+  size_t metric_len = coap_find_metric_option(data, data_len, &metric);
+
+  if(metric_len == 0) {
+    struct k_val values;
+
+    PRINTF("No metric option!\n");
+    memset(&values, 0, sizeof(values));
+    return values;
+  }
+  return coap_metrics_decode(metric, metric_len);
 }
 
 /** 
- * Function to get metric values into k_val struct from metric array
+ * Function to get metric values into k_val struct from metric array, array
+ * is left untouched. Two most significant bits of first byte carry version,
+ * following bits flag present metrics, values follow in the same order.
  */
-struct k_val coap_metrics_deserialization(uint8_t *metrics){
-  PRINTF("Coap metric deserialization\n");
-  PRINTF("1st flag number: %d\n",metrics[0]);
-  PRINTF("2nd flag number: %d\n",metrics[1]);
-  uint8_t numbers[8] = {128, 64, 32, 16, 8, 4, 2, 1};
-  uint8_t ii;
+struct k_val coap_metrics_decode(const uint8_t *metrics, size_t metrics_len)
+{
   struct k_val values;
-  uint8_t *p;
-  p=&values;
-  for(ii=1; ii<10; ii++){
-    *p=0;
-    p=p+1;
+  uint8_t *p = (uint8_t *)&values;
+  uint8_t ii;
+  uint8_t jj = 2;
+
+  memset(&values, 0, sizeof(values));
+  if(metrics_len < 2) {
+    return values;
   }
-  uint8_t jj=2;
-  p=&values;
-  metrics[0]=metrics[0]-64; //verzia
-  for(ii=2; ii<11; ii++){
-    if(metrics[(ii / 8)]>=numbers[ii % 8]){
-      metrics[(ii / 8)]=metrics[(ii / 8)]-numbers[ii % 8];
-      *p=metrics[jj];  
-      jj++;
+  for(ii = 2; ii < 11 && jj < metrics_len; ii++, p++) {
+    if(metrics[ii / 8] & (0x80 >> (ii % 8))) {
+      *p = metrics[jj++];
     }
-    p=p+1;
-  }
-  p=&values;
-  for(ii=1; ii<10; ii++){
-    PRINTF("%d\n", *p);
-    p=p+1;
   }
   return values;
 }
 
+/** 
+ * Function to get metric values into k_val struct from metric array
+ */
+struct k_val coap_metrics_deserialization(const uint8_t *metrics){
+  PRINTF("Coap metric deserialization\n");
+  return coap_metrics_decode(metrics, COAP_METRIC_LEN);
+}
+
 /** 
  * Function to create byte array from connection_profile struct
  */
@@ -265,8 +265,10 @@ typedef struct k_val {
     uint8_t link_load;
     uint8_t security;
   }k_val;
-struct k_val coap_get_k_val(uint8_t *data, uint16_t data_len);
-struct k_val coap_metrics_deserialization(uint8_t *metrics); 
+size_t coap_find_metric_option(const uint8_t *data, uint16_t data_len, const uint8_t **metric);
+struct k_val coap_get_k_val(const uint8_t *data, uint16_t data_len);
+struct k_val coap_metrics_decode(const uint8_t *metrics, size_t metrics_len);
+struct k_val coap_metrics_deserialization(const uint8_t *metrics);
 void coap_metrics_serialization(void *packet, struct connection_profiles *c);
 void coap_set_profile(const char *resource_url,void *packet, uip_ipaddr_t *server_ipaddr);
 int coap_change_profile_priority(const char *resource_url, unsigned int profile, uip_ipaddr_t *server_ipaddr, uint8_t direction);
@@ -7,6 +7,7 @@
 #include "net/ip/uip-debug.h"
 
 #include "contiki.h"
+#include "dev/leds.h"
 
 PROCESS(blinker, "blinker");
 
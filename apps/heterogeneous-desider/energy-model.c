@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+#define DEBUG 0
+#include "net/ip/uip-debug.h"
+
+#include "energy-model.h"
+#include "heterogeneous-desider.h"
+
+#include "contiki.h"
+#include "sys/energest.h"
+#if ENERGY_BATTERY
+#include "dev/battery-sensor.h"
+#endif
+
+#if ENERGY_MODEL
+#define ENERGY_MAX_COST (254UL * ENERGY_SCALE)
+#define ENERGY_MIN_LEVEL 16
+
+/**
+ * Consumption of one technology since last update
+ */
+typedef struct energy_tech {
+    uint8_t technology;
+    uint32_t bytes;
+    uint64_t charge;
+    uint32_t cost;      // decayed cost per byte, 0 if not known yet
+    uint8_t energy;     // metric set from cost by last update
+} energy_tech;
+
+static energy_tech techs[] = { { RPL_TECHNOLOGY }, { WIFI_TECHNOLOGY } };
+
+static unsigned long last_tx, last_serial;
+
+static energy_tech *find_energy_tech(uint8_t technology) {
+    uint8_t i;
+
+    for (i = 0; i < sizeof(techs) / sizeof(techs[0]); i++) {
+        if (techs[i].technology == technology)
+            return &techs[i];
+    }
+    return NULL;
+}
+
+/**
+ * Converts time measured by energest into charge
+ *
+ * @param ticks
+ * @param current in uA
+ * @return charge in nC
+ */
+static uint64_t ticks_to_charge(unsigned long ticks, uint32_t current) {
+    return (uint64_t) ticks * current * 1000 / RTIMER_SECOND;
+}
+
+/**
+ * Returns battery level where 256 is full battery
+ */
+static uint16_t battery_level() {
+#if ENERGY_BATTERY
+    int raw = battery_sensor.value(0);
+    uint32_t level;
+
+    if (raw >= ENERGY_BATTERY_FULL)
+        return 256;
+    if (raw <= ENERGY_BATTERY_EMPTY)
+        return ENERGY_MIN_LEVEL;
+    level = (uint32_t) (raw - ENERGY_BATTERY_EMPTY) * 256 / (ENERGY_BATTERY_FULL - ENERGY_BATTERY_EMPTY);
+    return level < ENERGY_MIN_LEVEL ? ENERGY_MIN_LEVEL : level;
+#else
+    return 256;
+#endif
+}
+
+/**
+ * Scales cost per byte into energy metric, lower battery level increases energy
+ */
+static uint8_t cost_to_energy(uint32_t cost, uint16_t level) {
+    uint32_t energy = cost * 256 / level / ENERGY_SCALE;
+
+    if (energy < 1)
+        return 1;
+    return energy > 254 ? 254 : energy;
+}
+
+void energy_model_init(void) {
+    PRINTF("Initializing energy model\n");
+    energest_flush();
+    last_tx = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+    last_serial = energest_type_time(ENERGEST_TYPE_SERIAL);
+#if ENERGY_BATTERY
+    SENSORS_ACTIVATE(battery_sensor);
+#endif
+}
+
+void energy_model_sent(uint8_t technology, uint16_t len) {
+    energy_tech *t = find_energy_tech(technology);
+
+    if (t) {
+        t->bytes += len;
+        if (technology == WIFI_TECHNOLOGY)
+            t->charge += (uint32_t) len * ENERGY_WIFI_BYTE_CHARGE;
+    }
+}
+
+/**
+ * Charges radio transmit and serial time spent since last update to technologies, computes new costs per byte and
+ * updates energy metrics. Radio listen time is not charged, it is spent whether packets are sent or not, so it is not
+ * the cost of a byte. Charge of technology which did not send anything since last update is dropped.
+ */
+void energy_model_update(void) {
+    unsigned long tx, serial;
+    uint16_t level = battery_level();
+    uint32_t sample;
+    uint8_t i;
+
+    energest_flush();
+    tx = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+    serial = energest_type_time(ENERGEST_TYPE_SERIAL);
+
+    find_energy_tech(RPL_TECHNOLOGY)->charge += ticks_to_charge(tx - last_tx, ENERGY_TX_CURRENT);
+    find_energy_tech(WIFI_TECHNOLOGY)->charge += ticks_to_charge(serial - last_serial, ENERGY_SERIAL_CURRENT);
+    last_tx = tx;
+    last_serial = serial;
+
+    for (i = 0; i < sizeof(techs) / sizeof(techs[0]); i++) {
+        energy_tech *t = &techs[i];
+
+        if (t->bytes == 0) {
+            t->charge = 0;
+            continue;
+        }
+        sample = t->charge / t->bytes > ENERGY_MAX_COST ? ENERGY_MAX_COST : t->charge / t->bytes;
+        if (t->cost == 0)
+            t->cost = sample ? sample : 1;
+        else if (sample > t->cost)
+            t->cost += (sample - t->cost) >> ENERGY_DECAY_SHIFT;
+        else
+            t->cost -= (t->cost - sample) >> ENERGY_DECAY_SHIFT;
+        t->bytes = 0;
+        t->charge = 0;
+
+        PRINTF("Energy cost of technology %d: %lu nC/B\n", t->technology, (unsigned long) t->cost);
+        t->energy = cost_to_energy(t->cost, level);
+        set_metrics_energy(t->technology, t->energy);
+    }
+}
+
+uint32_t energy_model_cost(uint8_t technology) {
+    energy_tech *t = find_energy_tech(technology);
+
+    return t ? t->cost : 0;
+}
+
+uint8_t energy_model_energy(uint8_t technology, uint8_t energy) {
+    energy_tech *t = find_energy_tech(technology);
+
+    return t && t->cost ? t->energy : energy;
+}
+#else
+void energy_model_init(void) {
+}
+
+void energy_model_sent(uint8_t technology, uint16_t len) {
+}
+
+void energy_model_update(void) {
+}
+
+uint32_t energy_model_cost(uint8_t technology) {
+    return 0;
+}
+
+uint8_t energy_model_energy(uint8_t technology, uint8_t energy) {
+    return energy;
+}
+#endif /* ENERGY_MODEL */
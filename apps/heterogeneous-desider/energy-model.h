@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+
+#ifndef CONTIKI_HETEROGENEOUS_ENERGY_MODEL_H
+#define CONTIKI_HETEROGENEOUS_ENERGY_MODEL_H
+
+#include "contiki.h"
+
+/**
+ * Energy metric of technologies computed from real consumption. Radio TX time measured by energest is charged to
+ * RPL, serial line time and estimated wifi charge per byte are charged to WIFI. Idle listening does not depend on
+ * traffic and is not charged. Charge spent during one update interval is divided by bytes sent using technology and
+ * decayed into energy cost per byte, which is scaled into metrics_struct.energy. When battery sensor is enabled, energy grows as battery drains.
+ *
+ * Charges are in nC, currents in uA. Model is enabled by default when energest is on (ENERGEST_CONF_ON).
+ */
+#ifdef HETEROGENEOUS_CONF_ENERGY_MODEL
+#define ENERGY_MODEL HETEROGENEOUS_CONF_ENERGY_MODEL
+#else
+#define ENERGY_MODEL ENERGEST_CONF_ON
+#endif
+
+#ifdef HETEROGENEOUS_CONF_ENERGY_TX_CURRENT
+#define ENERGY_TX_CURRENT HETEROGENEOUS_CONF_ENERGY_TX_CURRENT
+#else
+#define ENERGY_TX_CURRENT 24000
+#endif
+
+#ifdef HETEROGENEOUS_CONF_ENERGY_SERIAL_CURRENT
+#define ENERGY_SERIAL_CURRENT HETEROGENEOUS_CONF_ENERGY_SERIAL_CURRENT
+#else
+#define ENERGY_SERIAL_CURRENT 1000
+#endif
+
+/**
+ * Charge spent by linux device for one byte sent using wifi, mote can not measure it
+ */
+#ifdef HETEROGENEOUS_CONF_ENERGY_WIFI_BYTE_CHARGE
+#define ENERGY_WIFI_BYTE_CHARGE HETEROGENEOUS_CONF_ENERGY_WIFI_BYTE_CHARGE
+#else
+#define ENERGY_WIFI_BYTE_CHARGE 1500
+#endif
+
+/**
+ * New sample has weight 1 / 2^ENERGY_DECAY_SHIFT
+ */
+#ifdef HETEROGENEOUS_CONF_ENERGY_DECAY_SHIFT
+#define ENERGY_DECAY_SHIFT HETEROGENEOUS_CONF_ENERGY_DECAY_SHIFT
+#else
+#define ENERGY_DECAY_SHIFT 2
+#endif
+
+/**
+ * Cost per byte (nC) which is one unit of energy metric
+ */
+#ifdef HETEROGENEOUS_CONF_ENERGY_SCALE
+#define ENERGY_SCALE HETEROGENEOUS_CONF_ENERGY_SCALE
+#else
+#define ENERGY_SCALE 100
+#endif
+
+/**
+ * Set HETEROGENEOUS_CONF_ENERGY_BATTERY to 1 on platforms with battery-sensor, raw sensor values of full and empty
+ * battery must be configured too
+ */
+#ifdef HETEROGENEOUS_CONF_ENERGY_BATTERY
+#define ENERGY_BATTERY HETEROGENEOUS_CONF_ENERGY_BATTERY
+#else
+#define ENERGY_BATTERY 0
+#endif
+
+#ifdef HETEROGENEOUS_CONF_ENERGY_BATTERY_FULL
+#define ENERGY_BATTERY_FULL HETEROGENEOUS_CONF_ENERGY_BATTERY_FULL
+#else
+#define ENERGY_BATTERY_FULL 3000
+#endif
+
+#ifdef HETEROGENEOUS_CONF_ENERGY_BATTERY_EMPTY
+#define ENERGY_BATTERY_EMPTY HETEROGENEOUS_CONF_ENERGY_BATTERY_EMPTY
+#else
+#define ENERGY_BATTERY_EMPTY 2000
+#endif
+
+void energy_model_init(void);
+
+/**
+ * \brief       Accounts bytes sent using technology
+ * @param technology
+ * @param len
+ */
+void energy_model_sent(uint8_t technology, uint16_t len);
+
+/**
+ * \brief       Computes new energy costs and updates energy metrics, called periodically by purger
+ */
+void energy_model_update(void);
+
+/**
+ * \brief       Returns decayed energy cost per byte (nC) of technology or 0 if it is not known yet
+ * @param technology
+ * @return
+ */
+uint32_t energy_model_cost(uint8_t technology);
+
+/**
+ * \brief       Returns modeled energy metric of technology, or energy given by caller (reported by linux device or
+ *              default) while the model does not know cost of technology
+ * @param technology
+ * @param energy
+ * @return
+ */
+uint8_t energy_model_energy(uint8_t technology, uint8_t energy);
+
+#endif //CONTIKI_HETEROGENEOUS_ENERGY_MODEL_H
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+#define DEBUG 0
+#include "net/ip/uip-debug.h"
+
+#include "flow-table.h"
+
+#include "contiki.h"
+
+#include <string.h>
+
+#if MAX_FLOWS > 254
+#error "MAX_FLOWS must be lower than 255, flow ID is one byte"
+#endif
+
+#define FLOW_HASH_SIZE (MAX_FLOWS * 2)
+#define MAX_FLOW_ID 255
+
+static flow_struct flows[MAX_FLOWS];
+static flow_struct *free_list;
+static flow_struct *lru_head, *lru_tail;    // head is most recently used flow
+static uint16_t count;
+
+/**
+ * Hash slots contain flow index + 1, zero is empty slot. Collisions are resolved by linear probing
+ */
+static uint8_t hash_slots[FLOW_HASH_SIZE];
+static uint8_t id_index[MAX_FLOW_ID + 1];
+static uint8_t last_flow_id = 0;
+
+/**
+ * Computes hash of flow keys
+ */
+static uint16_t hash_keys(const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint8_t etx) {
+    uint16_t h = en ^ (bw << 3) ^ (etx << 6);
+    uint8_t i;
+
+    for (i = 0; i < sizeof(uip_ipaddr_t); i++) {
+        h = (h * 31) + to->u8[i];
+    }
+    return h % FLOW_HASH_SIZE;
+}
+
+static uint8_t keys_match(const flow_struct *flow, const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint8_t etx) {
+    return en == flow->energy && bw == flow->bandwidth && etx == flow->etx && uip_ipaddr_cmp(to, &flow->to);
+}
+
+/**
+ * Finds hash slot of flow with given keys or empty slot where flow should be inserted
+ */
+static uint16_t find_slot(const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint8_t etx) {
+    uint16_t i = hash_keys(to, en, bw, etx);
+
+    while (hash_slots[i] && !keys_match(&flows[hash_slots[i] - 1], to, en, bw, etx)) {
+        i = (i + 1) % FLOW_HASH_SIZE;
+    }
+    return i;
+}
+
+/**
+ * Removes slot from hash table, following entries of the cluster are shifted back so no tombstones are needed
+ */
+static void remove_slot(uint16_t i) {
+    uint16_t j = i, home;
+
+    hash_slots[i] = 0;
+    for (;;) {
+        j = (j + 1) % FLOW_HASH_SIZE;
+        if (!hash_slots[j])
+            return;
+        home = hash_keys(&flows[hash_slots[j] - 1].to, flows[hash_slots[j] - 1].energy,
+                         flows[hash_slots[j] - 1].bandwidth, flows[hash_slots[j] - 1].etx);
+        // entry in j may be moved to i only if its home slot is not cyclically in (i, j]
+        if ((j > i && (home <= i || home > j)) || (j < i && (home <= i && home > j))) {
+            hash_slots[i] = hash_slots[j];
+            hash_slots[j] = 0;
+            i = j;
+        }
+    }
+}
+
+static void lru_unlink(flow_struct *flow) {
+    if (flow->prev)
+        flow->prev->next = flow->next;
+    else
+        lru_head = flow->next;
+    if (flow->next)
+        flow->next->prev = flow->prev;
+    else
+        lru_tail = flow->prev;
+}
+
+static void lru_push(flow_struct *flow) {
+    flow->prev = NULL;
+    flow->next = lru_head;
+    if (lru_head)
+        lru_head->prev = flow;
+    else
+        lru_tail = flow;
+    lru_head = flow;
+}
+
+/**
+ * Generates new flow_id which is not used by other flow, IDs are used from 1 to MAX_FLOW_ID
+ *
+ * @return
+ */
+static uint8_t get_flow_id() {
+    do {
+        if (last_flow_id >= MAX_FLOW_ID)
+            last_flow_id = 1;
+        else
+            last_flow_id++;
+    } while (id_index[last_flow_id]);
+    return last_flow_id;
+}
+
+/**
+ * Initializes flow table
+ */
+void flow_table_init(void) {
+    uint16_t i;
+
+    memset(hash_slots, 0, sizeof(hash_slots));
+    memset(id_index, 0, sizeof(id_index));
+    free_list = NULL;
+    for (i = 0; i < MAX_FLOWS; i++) {
+        flows[i].next = free_list;
+        free_list = &flows[i];
+    }
+    lru_head = lru_tail = NULL;
+    count = 0;
+}
+
+flow_struct *flow_table_lookup(const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint8_t etx) {
+    uint16_t i = find_slot(to, en, bw, etx);
+
+    return hash_slots[i] ? &flows[hash_slots[i] - 1] : NULL;
+}
+
+flow_struct *flow_table_lookup_id(uint8_t id) {
+    return id_index[id] ? &flows[id_index[id] - 1] : NULL;
+}
+
+/**
+ * Removes flow from table and returns it to free list
+ *
+ * @param flow
+ */
+void flow_table_remove(flow_struct *flow) {
+    remove_slot(find_slot(&flow->to, flow->energy, flow->bandwidth, flow->etx));
+    id_index[flow->flow_id] = 0;
+    lru_unlink(flow);
+    flow->next = free_list;
+    free_list = flow;
+    count--;
+}
+
+/**
+ * Allocates flow, keys of flow must not be changed while it is in table
+ *
+ * @return
+ */
+flow_struct *flow_table_add(const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint8_t etx) {
+    flow_struct *flow;
+
+    if (free_list == NULL) {
+        PRINTF("Removing least recently used flow\n");
+        flow_table_remove(lru_tail);
+    }
+    flow = free_list;
+    free_list = flow->next;
+
+    memset(flow, 0, sizeof(flow_struct));
+    uip_ipaddr_copy(&flow->to, to);
+    flow->energy = en;
+    flow->bandwidth = bw;
+    flow->etx = etx;
+    flow->flow_id = get_flow_id();
+
+    hash_slots[find_slot(to, en, bw, etx)] = flow - flows + 1;
+    id_index[flow->flow_id] = flow - flows + 1;
+    lru_push(flow);
+    count++;
+    return flow;
+}
+
+void flow_table_touch(flow_struct *flow) {
+    if (lru_head != flow) {
+        lru_unlink(flow);
+        lru_push(flow);
+    }
+}
+
+void flow_table_clear(void) {
+    while (lru_head) {
+        flow_table_remove(lru_head);
+    }
+}
+
+flow_struct *flow_table_head(void) {
+    return lru_head;
+}
+
+flow_struct *flow_table_tail(void) {
+    return lru_tail;
+}
+
+uint16_t flow_table_count(void) {
+    return count;
+}
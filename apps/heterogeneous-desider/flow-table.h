@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+
+#ifndef CONTIKI_FLOW_TABLE_H
+#define CONTIKI_FLOW_TABLE_H
+
+#include "heterogeneous-desider.h"
+
+/**
+ * Flow table with fixed capacity (MAX_FLOWS). Flows are indexed by open addressing hash table keyed on
+ * (destination, en, bw, etx) and by flow_id, so lookups do not depend on number of flows. Flows are kept in LRU
+ * order, iteration with flow_table_head()/next pointer starts with most recently used flow. When table is full, least
+ * recently used flow is replaced.
+ */
+
+void flow_table_init(void);
+
+/**
+ * \brief       Finds flow by dst IPv6 address and metric keys
+ */
+flow_struct *flow_table_lookup(const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint8_t etx);
+
+/**
+ * \brief       Finds flow by its flow ID
+ */
+flow_struct *flow_table_lookup_id(uint8_t id);
+
+/**
+ * \brief       Allocates new flow with given keys and unique flow ID, evicts least recently used flow when table is full
+ */
+flow_struct *flow_table_add(const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint8_t etx);
+
+void flow_table_remove(flow_struct *flow);
+
+/**
+ * \brief       Marks flow as most recently used
+ */
+void flow_table_touch(flow_struct *flow);
+
+void flow_table_clear(void);
+
+flow_struct *flow_table_head(void);
+
+/**
+ * \brief       Returns least recently used flow, flows are refreshed when they are used, so it expires first
+ */
+flow_struct *flow_table_tail(void);
+
+uint16_t flow_table_count(void);
+
+#endif //CONTIKI_FLOW_TABLE_H
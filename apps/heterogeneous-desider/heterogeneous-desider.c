@@ -9,8 +9,13 @@
 #include "heterogeneous-desider.h"
 
 #include "serial-connection.h"
+#include "serial-frame.h"
+#include "flow-table.h"
+#include "pending.h"
+#include "energy-model.h"
 #include "blinker.h"
 #include "purger.h"
+#include "statistics.h"
 
 #include "contiki.h"
 #include "lib/random.h"
@@ -21,16 +26,21 @@
 #include "net/ip/uip-debug.h"
 #include "simple-udp.h"
 #include "net/ipv6/uip6.h"
+#include "net/ip/uip-udp-packet.h"
 
 #include "lib/memb.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "contiki.h"
+#include "dev/leds.h"
+#if CONTIKI_TARGET_ZOUL || CONTIKI_TARGET_CC2538DK
 #include "reg.h"
 #include "cpu.h"
 #include "dev/smwdthrosc.h"
+#endif
 
 #define UIP_IP_BUF   ((struct uip_udpip_hdr *)&uip_buf[UIP_LLH_LEN])
 
@@ -40,24 +50,28 @@ MEMB(tech_memb, struct tech_struct, MAX_TECHNOLOGIES);
 LIST(metrics_list);
 MEMB(metrics_memb, struct metrics_struct, MAX_TECHNOLOGIES);
 
-LIST(flow_list);
-MEMB(flow_memb, struct flow_struct, MAX_FLOWS);
-
 static uip_ipaddr_t src_ip;
 static uint8_t device_mode;
 
-static uint8_t flow_id = 0;
-const uint8_t MAX_FLOW_ID = 10;
-
 int sent_wifi;
 int sent_rpl;
 int wr_rate = 1;
 const int SIMULATED_BAT_CAPACITY = 4;
 
+/**
+ * Cache of technology decisions indexed by metric keys. Entry is valid while its generation matches
+ * metrics_generation, which changes only when some metrics row changes.
+ */
+typedef struct decision_struct {
+    uint8_t k_en;
+    uint8_t k_bw;
+    uint8_t k_etx;
+    uint8_t technology;
+    uint16_t generation;
+} decision_struct;
 
-#ifdef HETEROGENEOUS_STATISTICS
-static struct statistics stats;
-#endif
+static decision_struct decision_cache[DECISION_CACHE_SIZE];
+static uint16_t metrics_generation = 1;
 
 #ifdef SIMPLE_UDP_HETEROGENEOUS
 static struct simple_udp_connection *unicast_connection;    // Unicast connectin of parrent process
@@ -96,6 +110,15 @@ metrics_struct *find_metrics_by_tech(uint8_t type) {
     return s;
 }
 
+/**
+ * Renews validity for metric record, record is moved to the end of metrics list, so list stays ordered by expiration
+ */
+static void refresh_metrics(metrics_struct *metrics) {
+    metrics->refreshed = clock_time();
+    list_add(metrics_list, metrics);
+    purger_schedule(METRICS_VALIDITY);
+}
+
 /**
  * Renews validity for metric record specified by type
  */
@@ -104,7 +127,7 @@ void renew_metrics_validity(uint8_t type) {
 
     for(s = list_head(metrics_list); s != NULL; s = list_item_next(s)) {
         if (s->technology == type) {
-            s->validity = METRICS_VALIDITY;
+            refresh_metrics(s);
             break;
         }
     }
@@ -137,30 +160,73 @@ metrics_struct *find_metrics_by_tech_type(uint8_t type) {
  * @return
  */
 flow_struct *find_flow(const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint8_t etx) {
-    struct flow_struct *s;
+    flow_struct *flow = flow_table_lookup(to, en, bw, etx);
 
-    for(s = list_head(flow_list); s != NULL; s = list_item_next(s)) {
-        if (uip_ipaddr_cmp(to, &s->to) && en == s->energy && bw == s->bandwidth && etx == s->etx)
-            return s;
+    if (flow && flow->generation != metrics_generation) {
+        flow->technology = select_technology(en, bw, etx);
+        flow->generation = metrics_generation;
     }
-    return s;
+    return flow;
 }
 
 /**
- * Decreasing metrics validity
+ * Renews flow validity and marks flow as recently used
+ *
+ * @param flow
  */
-void purge_flows() {
-    struct flow_struct *s;
+void refresh_flow(flow_struct *flow) {
+    flow->refreshed = clock_time();
+    flow_table_touch(flow);
+}
 
-    for(s = list_head(flow_list); s != NULL; s = list_item_next(s)) {
-        if (s->validity <= PURGE_INTERVAL) {
-            list_remove(flow_list, s);
-            memb_free(&flow_memb, s);
-        }
-        else {
-            s->validity -= PURGE_INTERVAL;
-        }
+/**
+ * Invalidates all cached technology decisions, flows are recalculated when they are used next time. Generation 0 is
+ * never current, when counter wraps all entries are reset to it, so no stale entry matches a reused generation.
+ */
+static void metrics_changed() {
+    flow_struct *s;
+    uint16_t i;
+
+    PRINTF("Metrics changed\n");
+    if (++metrics_generation == 0) {
+        for (i = 0; i < DECISION_CACHE_SIZE; i++)
+            decision_cache[i].generation = 0;
+        for (s = flow_table_head(); s != NULL; s = s->next)
+            s->generation = 0;
+        metrics_generation = 1;
+    }
+}
+
+/**
+ * Returns time remaining until entry refreshed at given time expires, 0 if it is expired
+ *
+ * @param refreshed
+ * @param validity in seconds
+ * @return
+ */
+static clock_time_t time_to_expire(clock_time_t refreshed, unsigned long validity) {
+    clock_time_t age = clock_time() - refreshed;
+
+    return age >= validity * CLOCK_SECOND ? 0 : validity * CLOCK_SECOND - age;
+}
+
+/**
+ * Removes expired flows, every refresh moves flow to the head of flow table, so expired flows are at its tail
+ *
+ * @return time until next flow expires, 0 if flow table is empty
+ */
+static clock_time_t purge_flows() {
+    struct flow_struct *s;
+    clock_time_t remaining;
+
+    while ((s = flow_table_tail()) != NULL) {
+        remaining = time_to_expire(s->refreshed, FLOW_VALIDITY);
+        if (remaining)
+            return remaining;
+        PRINTF("Flow %d expired\n", s->flow_id);
+        flow_table_remove(s);
     }
+    return 0;
 }
 
 /**
@@ -169,38 +235,70 @@ void purge_flows() {
  * @param tech_type
  */
 void remove_flows_by_tech(uint8_t tech_type) {
-    struct flow_struct *s;
+    struct flow_struct *s, *next;
 
-    for(s = list_head(flow_list); s != NULL; s = list_item_next(s)) {
+    for(s = flow_table_head(); s != NULL; s = next) {
+        next = s->next;
         if (s->technology == tech_type) {
-            list_remove(flow_list, s);
-            memb_free(&flow_memb, s);
+            flow_table_remove(s);
         }
     }
 }
 
 /**
- * Decreasing metrics validity except metrics with RPL tech type
+ * Returns nonzero when metrics of technology do not expire (RPL and static drivers)
+ *
+ * @param type
+ * @return
  */
-void  purge_metrics() {
-    struct metrics_struct *s;
+static uint8_t static_metrics(uint8_t type) {
+    struct tech_struct *tech = find_tech_by_type(type);
 
-    for (s = list_head(metrics_list); s != NULL; s = list_item_next(s)) {
-        if (s->technology != RPL_TECHNOLOGY) {
-            if (s->validity <= PURGE_INTERVAL) {
-                list_remove(metrics_list, s);
-                remove_flows_by_tech(s->technology);
-                memb_free(&metrics_memb, s);
-            }
-            else {
-                s->validity -= PURGE_INTERVAL;
-            }
-        }
+    return type == RPL_TECHNOLOGY || (tech && tech->driver && (tech->driver->flags & TECH_F_STATIC));
+}
+
+/**
+ * Removes expired metrics except metrics of static technologies (RPL), metrics list is ordered by refresh time
+ *
+ * @return time until next metrics expire, 0 if no metrics expire
+ */
+static clock_time_t purge_metrics() {
+    struct metrics_struct *s, *next;
+    clock_time_t remaining;
+
+    for (s = list_head(metrics_list); s != NULL; s = next) {
+        next = list_item_next(s);
+        if (static_metrics(s->technology))
+            continue;
+        remaining = time_to_expire(s->refreshed, METRICS_VALIDITY);
+        if (remaining)
+            return remaining;
+        PRINTF("Metrics of technology %d expired\n", s->technology);
+        list_remove(metrics_list, s);
+        remove_flows_by_tech(s->technology);
+        memb_free(&metrics_memb, s);
+        metrics_changed();
     }
+    return 0;
 }
 
 /**
- * Allows to find flow by dst IPv6 address and metric keys
+ * Removes expired flows and metrics
+ *
+ * @return time until next entry expires, 0 if no entry expires
+ */
+clock_time_t purge_expired(void) {
+    clock_time_t metrics_next = purge_metrics();
+    clock_time_t flows_next = purge_flows();
+
+    if (metrics_next == 0 || (flows_next && flows_next < metrics_next))
+        return flows_next;
+    return metrics_next;
+}
+
+/**
+ * Allows to find flow by dst IPv6 address and metric keys, flow table keeps one flow for every key, so it is the
+ * flow returned by find_flow
  *
  * @param to
  * @param en
@@ -209,18 +307,7 @@ void  purge_metrics() {
  * @return
  */
 flow_struct *find_best_flow(const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint8_t etx) {
-    struct flow_struct *s, *best = NULL;
-
-    for(s = list_head(flow_list); s != NULL; s = list_item_next(s)) {
-        if (uip_ipaddr_cmp(to, &s->to) && en == s->energy && bw == s->bandwidth && etx == s->etx)
-            if (best) {
-                if (s->flags & UP)
-                    best = s;
-            }
-            else
-                best = s;
-    }
-    return best;
+    return find_flow(to, en, bw, etx);
 }
 
 /**
@@ -230,38 +317,25 @@ flow_struct *find_best_flow(const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint
  * @return
  */
 flow_struct *find_flow_by_id(uint8_t id) {
-    struct flow_struct *s;
-
-    for(s = list_head(flow_list); s != NULL; s = list_item_next(s)) {
-        if (id == s->flow_id)
-            return s;
-    }
-    return s;
+    return flow_table_lookup_id(id);
 }
 
 /**
- * Generates new flow_id, if it reaches limit, flow_id starts again from 1
- *
- * @return
+ * Removes all flows from database
  */
-int get_flow_id() {
-    if (flow_id > MAX_FLOW_ID)
-        flow_id = 1;
-    else
-        flow_id++;
-    return flow_id;
+void clear_flows() {
+    PRINTF("Clearing flows\n");
+    flow_table_clear();
 }
 
 /**
- * Removes all flows from database
+ * Clears announced flag of all flows, used when linux device switches serial mode
  */
-void clear_flows() {
-    PRINTF("Clearing flows\n");
+void clear_flow_announcements() {
     struct flow_struct *s;
 
-    while(s = list_head(flow_list)) {
-        list_remove(flow_list, s);
-        memb_free(&flow_memb, s);
+    for(s = flow_table_head(); s != NULL; s = s->next) {
+        s->flags &= ~ANN;
     }
 }
 
@@ -281,62 +355,61 @@ int calculate_m(struct metrics_struct *ms, uint8_t k_en, uint8_t k_bw, uint8_t k
 }
 
 /**
- * Function used for technology selection
+ * Computes cost of technology using cost model of its driver
+ *
+ * @param ms
+ * @param k_en
+ * @param k_bw
+ * @param k_etx
+ * @return
+ */
+static int technology_cost(struct metrics_struct *ms, uint8_t k_en, uint8_t k_bw, uint8_t k_etx) {
+    struct tech_struct *tech = find_tech_by_type(ms->technology);
+
+    if (tech && tech->driver && tech->driver->cost)
+        return tech->driver->cost(tech->driver, ms, k_en, k_bw, k_etx);
+    return calculate_m(ms, k_en, k_bw, k_etx);
+}
+
+/**
+ * Function used for technology selection, computes metric for all technologies
  *
  * @param data
  * @return
  */
-uint8_t select_technology(uint8_t k_en, uint8_t k_bw, uint8_t k_etx) {
+static uint8_t compute_technology(uint8_t k_en, uint8_t k_bw, uint8_t k_etx) {
     int m_res = -1;
     uint8_t selected_technology;
     struct metrics_struct *s;
 
     for(s = list_head(metrics_list); s != NULL; s = list_item_next(s)) {
-        if (m_res == -1) {
+        int m_actual = technology_cost(s, k_en, k_bw, k_etx);
+        if (m_res == -1 || m_actual < m_res) {
             selected_technology = s->technology;
-            m_res = calculate_m(s, k_en, k_bw, k_etx);
-        }
-        else {
-            int m_actual = calculate_m(s, k_en, k_bw, k_etx);
-            if (m_actual < m_res) {
-                selected_technology = s->technology;
-                m_res = calculate_m(s, k_en, k_bw, k_etx);
-            }
+            m_res = m_actual;
         }
     }
     return selected_technology;
 }
 
 /**
- * Recalculate metric in all flows (may change destination technology)
- */
-void recalculate_flows() {
-    PRINTF("Recalculating flows\n");
-    struct flow_struct *s;
-    struct tech_struct *t;
-
-    for(s = list_head(flow_list); s != NULL; s = list_item_next(s)) {
-        t = select_technology(s->energy, s->bandwidth, s->etx);
-        if (s->technology != t)
-            s->technology = t;
-    }
-}
-
-/**
- * Removes oldest flow
+ * Function used for technology selection, decision is taken from cache when metrics did not change since it was
+ * computed
+ *
+ * @param data
+ * @return
  */
-void clear_oldest_flow() {
-    PRINTF("Removing oldest flow\n");
-    struct flow_struct *s, *oldest_flow = list_head(flow_list);
-
-    s = list_item_next(oldest_flow);
-    for(s = list_head(flow_list); s != NULL; s = list_item_next(s)) {
-        if (s->validity < oldest_flow->validity)
-            oldest_flow = s;
+uint8_t select_technology(uint8_t k_en, uint8_t k_bw, uint8_t k_etx) {
+    decision_struct *d = &decision_cache[(k_en * 7 + k_bw * 3 + k_etx) % DECISION_CACHE_SIZE];
+
+    if (d->generation != metrics_generation || d->k_en != k_en || d->k_bw != k_bw || d->k_etx != k_etx) {
+        d->k_en = k_en;
+        d->k_bw = k_bw;
+        d->k_etx = k_etx;
+        d->technology = compute_technology(k_en, k_bw, k_etx);
+        d->generation = metrics_generation;
     }
-
-    list_remove(flow_list, oldest_flow);
-    memb_free(&flow_memb, oldest_flow);
+    return d->technology;
 }
 
 /**
@@ -357,7 +430,7 @@ void recalculate_metrics() {
         else {
             PRINTF("Setting up new energy metrics for WIFI technology: %d\n", w_en_increment);
             wifi_metrics->energy = w_en_increment;
-            recalculate_flows();
+            metrics_changed();
         }
     }
 
@@ -367,15 +440,32 @@ void recalculate_metrics() {
         else {
             PRINTF("Setting up new energy metrics for RPL technology: %d\n", r_en_increment);
             rpl_metrics->energy = r_en_increment;
-            recalculate_flows();
+            metrics_changed();
         }
     }
 }
 
+/**
+ * Sets energy metric of technology computed by energy model
+ *
+ * @param technology
+ * @param energy
+ */
+void set_metrics_energy(uint8_t technology, uint8_t energy) {
+    struct metrics_struct *metrics = find_metrics_by_tech_type(technology);
+
+    if (metrics && metrics->energy != energy) {
+        PRINTF("Setting up new energy metrics for technology %d: %d\n", technology, energy);
+        metrics->energy = energy;
+        metrics_changed();
+    }
+}
+
 /**
  * Increments wifi counter and recalculates metrics
  */
-void inc_wifi_sent() {
+void inc_wifi_sent(uint16_t len) {
+    energy_model_sent(WIFI_TECHNOLOGY, len);
 #ifdef ALLOW_SIMULATE_BATTERY
     sent_wifi++;
     recalculate_metrics();
@@ -385,7 +475,8 @@ void inc_wifi_sent() {
 /**
  * Increments rpl counter and recalculates metrics
  */
-void inc_sent_rpl() {
+void inc_sent_rpl(uint16_t len) {
+    energy_model_sent(RPL_TECHNOLOGY, len);
 #ifdef ALLOW_SIMULATE_BATTERY
     sent_rpl++;
     recalculate_metrics();
@@ -404,15 +495,34 @@ tech_struct *add_technology(uint8_t type)  {
         tech = memb_alloc(&tech_memb);
         if (tech==NULL) {
             printf("Maximum tech capacity exceeded\n");
+            return NULL;
         }
         PRINTF("Adding new technology type %d\n", type);
         tech->type = type;
+        tech->driver = NULL;
 
         list_add(tech_list, tech);
     }
     return tech;
 }
 
+/**
+ * Registers technology driver, technology becomes available for selection once metrics are added for its type
+ *
+ * @param driver
+ * @return
+ */
+tech_struct *register_technology(const tech_driver *driver) {
+    struct tech_struct *tech = add_technology(driver->type);
+
+    if (tech && tech->driver != driver) {
+        PRINTF("Registering technology driver %s\n", driver->name);
+        tech->driver = driver;
+        metrics_changed();
+    }
+    return tech;
+}
+
 /**
  * Function allows to add metrics into Metrics table, which is linked to technology
  */
@@ -426,43 +536,51 @@ metrics_struct *add_metrics(uint8_t technology, uint8_t energy, uint8_t bandwidt
         }
         PRINTF("Adding new metrics for type %d (%d, %d, %d)\n", technology, energy, bandwidth, etx);
         list_add(metrics_list, metrics);
+        metrics_changed();
+    }
+    else if (metrics->energy != energy || metrics->bandwidth != bandwidth || metrics->etx != etx) {
+        metrics_changed();
     }
     metrics->technology = technology;
     metrics->energy = energy;
     metrics->bandwidth = bandwidth;
     metrics->etx = etx;
-    metrics->validity = METRICS_VALIDITY;
+    refresh_metrics(metrics);
     return metrics;
 }
 
 /**
- * Adds flow to flow_list, stores metrics, validation time and destination address. If target tech is wifi and node-mode
- * is ROOT, device needs to ask using serial line, if destination device is available using WIFI technology. This is done
- * by set up PND flag to true. If target tech is WIFI and mode is casual node, wifi always sends data to ROOT device,
- * which should be always accessible. Thus, flag is set up to CNF.
+ * Returns nonzero if flows using technology must be confirmed by linux device
+ *
+ * @param type
+ * @return
  */
-flow_struct *add_flow(const uip_ipaddr_t *to, uint8_t tech, uint8_t en, uint8_t bw, uint8_t etx) {
-    struct flow_struct *flow;
-
-    flow = memb_alloc(&flow_memb);
+static uint8_t technology_needs_confirmation(uint8_t type) {
+    struct tech_struct *tech = find_tech_by_type(type);
 
-    while (flow == NULL) {
-        clear_oldest_flow();
-        flow = memb_alloc(&flow_memb);
-    }
+    if (tech && tech->driver)
+        return tech->driver->flags & TECH_F_CONFIRM;
+    return type == WIFI_TECHNOLOGY;
+}
 
-    list_add(flow_list, flow);
+/**
+ * Adds flow to flow table (least recently used flow is replaced when table is full), stores metrics, validation time
+ * and destination address. If target tech needs confirmation (wifi) and node-mode is ROOT, device needs to ask using
+ * serial line, if destination device is available using WIFI technology. This is done by set up PND flag to true. If
+ * target tech is WIFI and mode is casual node, wifi always sends data to ROOT device, which should be always
+ * accessible. Thus, flag is set up to CNF.
+ */
+flow_struct *add_flow(const uip_ipaddr_t *to, uint8_t tech, uint8_t en, uint8_t bw, uint8_t etx) {
+    struct flow_struct *flow;
 
-    uip_ipaddr_copy(&flow->to, to);
+    flow = flow_table_add(to, en, bw, etx);
 
-    flow->flow_id = get_flow_id();
     flow->technology = tech;
-    flow->energy = en;
-    flow->bandwidth = bw;
-    flow->etx = etx;
-    flow->validity = FLOW_VALIDITY;
+    flow->generation = metrics_generation;
+    flow->refreshed = clock_time();
+    purger_schedule(FLOW_VALIDITY);
 
-    if (tech == WIFI_TECHNOLOGY)
+    if (technology_needs_confirmation(tech))
         if (device_mode == MODE_ROOT)
             flow->flags = PND;
         else
@@ -502,7 +620,9 @@ void print_metrics_table() {
 
     printf("types(1->wifi, 2->RPL)/validity: energy, bandwidth, etx\n");
     for(s = list_head(metrics_list); s != NULL; s = list_item_next(s)) {
-        printf("Metrics tech(%d)/%d:  %d %d %d\n", s->technology, s->validity, s->energy, s->bandwidth, s->etx);
+        printf("Metrics tech(%d)/%lu:  %d %d %d\n", s->technology,
+               (unsigned long) (time_to_expire(s->refreshed, METRICS_VALIDITY) / CLOCK_SECOND), s->energy,
+               s->bandwidth, s->etx);
     }
 }
 
@@ -513,11 +633,12 @@ void print_flow_table() {
     struct flow_struct *s;
 
     printf("ID: <id> Flow: -> <to> en/bw/etx - tech(1-wifi/2-rpl), valid(time), flags\n");
-    for(s = list_head(flow_list); s != NULL; s = list_item_next(s)) {
+    for(s = flow_table_head(); s != NULL; s = s->next) {
         printf("ID: %d ", s->flow_id);
         printf("Flow: -> ");
         uip_debug_ipaddr_print(&s->to);
-        printf(" %d/%d/%d - %d, %d, %d-", s->energy, s->bandwidth, s->etx, s->technology, s->validity, s->flags);
+        printf(" %d/%d/%d - %d, %lu, %d-", s->energy, s->bandwidth, s->etx, s->technology,
+               (unsigned long) (time_to_expire(s->refreshed, FLOW_VALIDITY) / CLOCK_SECOND), s->flags);
         if (s->flags & CNF)
             printf("confirmed,");
         if (s->flags & PND)
@@ -551,7 +672,7 @@ void print_neighbours() {
  * @param bw
  * @param etx
  */
-void fill_keys(const void *data,uint8_t len, uint8_t *en, uint8_t *bw, uint8_t *etx) {
+void fill_keys(const void *data, uint16_t len, uint8_t *en, uint8_t *bw, uint8_t *etx) {
 #ifdef SIMPLE_UDP_HETEROGENEOUS
     int type = (int) data;
     uint8_t val = strtol(data, &data, 10);
@@ -592,7 +713,7 @@ void add_from_flow(const uip_ipaddr_t *from, flow_struct *dst_flow, uint8_t tech
 
     if (!flow) {
         flow = add_flow(from, tech_type, k_en, k_bw, k_etx);
-        flow->flags = dst_flow->flags | UP;
+        flow->flags = (dst_flow->flags & ~ANN) | UP;
     }
 }
 
@@ -612,17 +733,40 @@ void ask_for_route(flow_struct *flow){
 }
 
 /**
- * Sends packet using wifi (through serial line)
+ * Sends packet using wifi (through serial line). In binary serial mode packet is sent as one frame (or record of batch
+ * frame in batch mode), addresses are omitted once linux device knows them for flow id of locally originated flow.
  *
+ * @param flow
  * @param from
  * @param to
  * @param remote_port
  * @param src_port
  * @param data
  */
-void send_packet_wifi(uip_ipaddr_t *from, const uip_ipaddr_t *to, uint16_t remote_port, uint16_t src_port, const void *data, uint16_t len) {
+void send_packet_wifi(flow_struct *flow, const uip_ipaddr_t *from, const uip_ipaddr_t *to, uint16_t remote_port,
+                      uint16_t src_port, const void *data, uint16_t len) {
     PRINTF("Seinding packet using WIFI technology\n");
 
+    if (serial_mode != SERIAL_MODE_ASCII) {
+        uint8_t flags = 0;
+
+        if (!(flow->flags & ANN) || !uip_ipaddr_cmp(from, &src_ip)) {
+            flags = SERIAL_FRAME_F_ADDR;
+            if (uip_ipaddr_cmp(from, &src_ip)) {
+                flags |= SERIAL_FRAME_F_CACHE;
+                flow->flags |= ANN;
+            }
+        }
+        if (serial_mode == SERIAL_MODE_BATCH)
+            serial_frame_batch_packet(SERIAL_FRAME_PACKET, flags, flow->flow_id, from, to, remote_port, src_port, data,
+                                      len);
+        else
+            serial_frame_write_packet(SERIAL_FRAME_PACKET, flags, flow->flow_id, from, to, remote_port, src_port,
+                                      data, len);
+        inc_wifi_sent(len);
+        return;
+    }
+
     uint8_t *converted = (uint8_t*) data;
     printf("!p;");
     uip_debug_ipaddr_print(from);
@@ -635,7 +779,207 @@ void send_packet_wifi(uip_ipaddr_t *from, const uip_ipaddr_t *to, uint16_t remot
         printf("%02x",converted[i]);
     }
     printf("\n");
-    inc_wifi_sent();
+    inc_wifi_sent(len);
+}
+
+/**
+ * Send function of wifi driver
+ */
+static int wifi_send(const tech_driver *driver, const tech_packet *packet) {
+    send_packet_wifi(packet->flow, packet->from, packet->to, packet->remote_port, packet->src_port, packet->data,
+                     packet->len);
+    return 1;
+}
+
+const tech_driver rpl_driver = { "rpl", RPL_TECHNOLOGY, TECH_F_STATIC, RPL_CAPACITY, DEFAULT_RPL_EN, NULL, NULL };
+const tech_driver wifi_driver = { "wifi", WIFI_TECHNOLOGY, TECH_F_CONFIRM, WIFI_CAPACITY, 0, wifi_send, NULL };
+
+/**
+ * Returns driver usable for flow or NULL when technology is RPL, has no send function or flow is not confirmed yet
+ *
+ * @param flow
+ * @param type
+ * @return
+ */
+static const tech_driver *usable_driver(flow_struct *flow, uint8_t type) {
+    struct tech_struct *tech = find_tech_by_type(type);
+
+    if (type == RPL_TECHNOLOGY || !tech || !tech->driver || !tech->driver->send)
+        return NULL;
+    if ((tech->driver->flags & TECH_F_CONFIRM) && !(flow->flags & CNF))
+        return NULL;
+    return tech->driver;
+}
+
+#if SPLIT_FLOWS
+/**
+ * Chooses technology for next packet of flow. Every technology usable by flow with cost close to the cost of best one
+ * gets share of packets proportional to its capacity. Flow counter is stepped by odd constant, so packets of different
+ * technologies are interleaved and shares are exact over 256 packets.
+ *
+ * @param flow
+ * @return
+ */
+static uint8_t split_technology(flow_struct *flow) {
+    struct metrics_struct *s;
+    struct tech_struct *tech;
+    int cost[MAX_TECHNOLOGIES], best = -1;
+    uint16_t capacity[MAX_TECHNOLOGIES];
+    uint8_t type[MAX_TECHNOLOGIES];
+    uint8_t n = 0, i;
+    uint32_t total = 0, position;
+
+    for(s = list_head(metrics_list); s != NULL && n < MAX_TECHNOLOGIES; s = list_item_next(s)) {
+        tech = find_tech_by_type(s->technology);
+        if (!tech || !tech->driver || (s->technology != RPL_TECHNOLOGY && !usable_driver(flow, s->technology)))
+            continue;
+        type[n] = s->technology;
+        capacity[n] = tech->driver->capacity;
+        cost[n] = technology_cost(s, flow->energy, flow->bandwidth, flow->etx);
+        if (best == -1 || cost[n] < best)
+            best = cost[n];
+        n++;
+    }
+
+    for (i = 0; i < n; i++) {
+        if ((long) cost[i] * 100 <= (long) best * (100 + SPLIT_TOLERANCE))
+            total += capacity[i];
+    }
+    if (total == 0)
+        return flow->technology;
+
+    position = ((uint8_t) (flow->split_counter++ * 159) * total) >> 8;
+    for (i = 0; i < n; i++) {
+        if ((long) cost[i] * 100 <= (long) best * (100 + SPLIT_TOLERANCE)) {
+            if (position < capacity[i])
+                return type[i];
+            position -= capacity[i];
+        }
+    }
+    return flow->technology;
+}
+#endif
+
+/**
+ * Returns driver which sends next packet of flow, NULL means packet goes using RPL
+ *
+ * @param flow
+ * @return
+ */
+static const tech_driver *packet_driver(flow_struct *flow) {
+#if SPLIT_FLOWS
+    return usable_driver(flow, split_technology(flow));
+#else
+    return usable_driver(flow, flow->technology);
+#endif
+}
+
+/**
+ * Sends packet using technology driver
+ *
+ * @param forwarded nonzero for packets of other nodes
+ * @param latency   clock ticks packet waited for route answer
+ */
+static int send_packet_driver(const tech_driver *driver, flow_struct *flow, const uip_ipaddr_t *from,
+                              const uip_ipaddr_t *to, uint16_t remote_port, uint16_t src_port, const void *data,
+                              uint16_t len, uint8_t forwarded, clock_time_t latency) {
+    tech_packet packet;
+    int sent;
+
+    packet.flow = flow;
+    packet.from = from;
+    packet.to = to;
+    packet.remote_port = remote_port;
+    packet.src_port = src_port;
+    packet.data = data;
+    packet.len = len;
+    PRINTF("Sending packet using %s driver\n", driver->name);
+    sent = driver->send(driver, &packet);
+    if (sent)
+        statistics_sent(flow, driver->type, len, forwarded, latency);
+    else
+        statistics_dropped(flow, driver->type);
+    return sent;
+}
+
+/**
+ * Holds packet of pending flow until route question is answered. Route is asked once per flow, again only when
+ * the question was not answered within PENDING_TIMEOUT. Packet which does not fit into queue is dropped while older
+ * packets of flow are held, so flow is not reordered.
+ *
+ * @return nonzero if packet was held or dropped
+ */
+static uint8_t hold_packet(flow_struct *flow, uint8_t kind, void *conn, const uip_ipaddr_t *from,
+                           const uip_ipaddr_t *to, uint16_t remote_port, uint16_t src_port, uint16_t rpl_port,
+                           const void *data, uint16_t len) {
+    uint8_t queued = pending_enqueue(flow, kind, conn, from, to, remote_port, src_port, rpl_port, data, len);
+
+    if (!(flow->flags & ASK) || (clock_time_t)(clock_time() - flow->asked) >= PENDING_TIMEOUT) {
+        ask_for_route(flow);
+        flow->flags |= ASK;
+        flow->asked = clock_time();
+        statistics_query_sent(flow);
+    }
+    if (queued == PENDING_NOT_QUEUED && pending_held(flow) > 0) {
+        PRINTF("Dropping packet, older packets of flow %d are held\n", flow->flow_id);
+        statistics_dropped(flow, RPL_TECHNOLOGY);
+        return 1;
+    }
+    return queued != PENDING_NOT_QUEUED;
+}
+
+/**
+ * Makes flow pending again when its route question timed out and PENDING_BACKOFF passed, so route is asked again
+ *
+ * @param flow
+ */
+static void retry_pending(flow_struct *flow) {
+    if ((flow->flags & (ASK | PND)) == ASK && technology_needs_confirmation(flow->technology) &&
+        (clock_time_t)(clock_time() - flow->asked) >= PENDING_BACKOFF) {
+        flow->flags &= ~ASK;
+        flow->flags |= PND;
+    }
+}
+
+/**
+ * Sends packet which was held while route question was pending, using technology of its flow. If flow does not
+ * exist anymore or technology is not usable, packet is sent using RPL.
+ *
+ * @param p
+ */
+void send_pending_packet(pending_packet *p) {
+    flow_struct *flow = find_flow_by_id(p->flow_id);
+    const tech_driver *driver = NULL;
+    clock_time_t latency = clock_time() - p->queued;
+
+    if (flow && !uip_ipaddr_cmp(&flow->to, &p->to))
+        flow = NULL;
+    if (flow)
+        driver = packet_driver(flow);
+
+    if (driver) {
+        send_packet_driver(driver, flow, &p->from, &p->to, p->remote_port, p->src_port, p->data, p->len,
+                           p->kind == PENDING_FORWARD, latency);
+        leds_on(WIFI_SEND_LED);
+        return;
+    }
+
+    switch (p->kind) {
+#ifdef SIMPLE_UDP_HETEROGENEOUS
+        case PENDING_SIMPLE_UDP:
+            simple_udp_sendto(p->conn, p->data, p->len, &p->to);
+            break;
+#endif
+        case PENDING_UDP:
+            uip_udp_packet_sendto(p->conn, p->data, p->len, &p->to, p->rpl_port);
+            break;
+        case PENDING_FORWARD:
+            uip_udp_packet_forward(&p->from, &p->to, p->remote_port, p->src_port, p->data, p->len);
+            break;
+    }
+    leds_on(RPL_SEND_LED);
+    inc_sent_rpl(p->len);
+    statistics_sent(flow, RPL_TECHNOLOGY, p->len, p->kind == PENDING_FORWARD, latency);
 }
 
 /**
@@ -659,24 +1003,22 @@ int heterogenous_simple_udp_sendto(struct simple_udp_connection *c, const void *
     }
 
     if (flow) {
-        if (flow->flags & PND) {    // need to ask for route (pending flag active)
-            PROCESS_CONTEXT_BEGIN(&serial_connection);
-            ask_for_route(flow);
-            PROCESS_CONTEXT_END();
+        retry_pending(flow);
+        if (flow->flags & PND) {    // need to ask for route (pending flag active), packet waits for answer
+            if (hold_packet(flow, PENDING_SIMPLE_UDP, c, &src_ip, to, UIP_HTONS(c->remote_port),
+                            UIP_HTONS(c->local_port), 0, data, datalen))
+                return 0;
         }
-        if (flow->technology == RPL_TECHNOLOGY || !(flow->flags & CNF)) {    //dst tech is wifi or not approved wifi
+        const tech_driver *driver = packet_driver(flow);
+        if (driver == NULL) {    //dst tech is rpl or not approved wifi
             simple_udp_sendto(c, data, datalen, to);
             leds_on(RPL_SEND_LED);
-            inc_sent_rpl();
-#ifdef HETEROGENEOUS_STATISTICS
-            stats.rpl_sent++;
-#endif
-        } else if (flow->technology == WIFI_TECHNOLOGY && (flow->flags & CNF == 1)) {
-            send_packet_wifi(&src_ip, to, UIP_HTONS(c->remote_port), UIP_HTONS(c->local_port), data, datalen);
+            inc_sent_rpl(datalen);
+            statistics_sent(flow, RPL_TECHNOLOGY, datalen, 0, 0);
+        } else {
+            send_packet_driver(driver, flow, &src_ip, to, UIP_HTONS(c->remote_port), UIP_HTONS(c->local_port), data,
+                               datalen, 0, 0);
             leds_on(WIFI_SEND_LED);
-#ifdef HETEROGENEOUS_STATISTICS
-            stats.wifi_sent++;
-#endif
         }
     }
     return 0;
@@ -706,7 +1048,7 @@ int heterogeneous_forwarding_callback() {
         PRINTF("R: Flow not found, creating new one\n");
         uint8_t dst_technology = select_technology(k_en, k_bw, k_etx);
         flow = add_flow(&(UIP_IP_BUF->destipaddr), dst_technology, k_en, k_bw, k_etx);
-        if (dst_technology == WIFI_TECHNOLOGY)  // if target tech is WIFI, we must tag it as pending
+        if (technology_needs_confirmation(dst_technology))  // if target tech is WIFI, we must tag it as pending
             flow->flags |= PND;
     }
 
@@ -722,22 +1064,27 @@ int heterogeneous_forwarding_callback() {
     }
 
     if (flow) {
-        flow->validity = FLOW_VALIDITY;
+        refresh_flow(flow);
+        retry_pending(flow);
         PRINTF("R: flow flags: %d\n", flow->flags);
-        if (flow->technology == WIFI_TECHNOLOGY && flow->flags & PND) {    // need to ask for route (pending flag active)
+        if (technology_needs_confirmation(flow->technology) && flow->flags & PND) {    // need to ask for route (pending flag active)
             PRINTF("R: Try pending flow\n");
-            PROCESS_CONTEXT_BEGIN(&serial_connection);
-            ask_for_route(flow);
-            PROCESS_CONTEXT_END();
+            if (hold_packet(flow, PENDING_FORWARD, NULL, &(UIP_IP_BUF->srcipaddr), &(UIP_IP_BUF->destipaddr),
+                            UIP_HTONS(UIP_IP_BUF->destport), UIP_HTONS(UIP_IP_BUF->srcport), 0, uip_appdata - 4,
+                            uip_datalen() - (UIP_LLH_LEN + UIP_IPH_LEN + 16)))
+                return 0;
         }
-        if (flow->technology == RPL_TECHNOLOGY || !(flow->flags & CNF)) {    //dst tech is wifi or not approved wifi
+        const tech_driver *driver = packet_driver(flow);
+        if (driver == NULL) {    //dst tech is rpl or not approved wifi
             PRINTF("R: Forwarding RPL\n");
             leds_on(RPL_FORWARD_LED);
+            statistics_sent(flow, RPL_TECHNOLOGY, uip_datalen() - (UIP_LLH_LEN + UIP_IPH_LEN + 16), 1, 0);
             return 1;
-        } else if (flow->technology == WIFI_TECHNOLOGY && (flow->flags & CNF == 1)) {
-            PRINTF("R: Forwarding WIFI\n");
-            send_packet_wifi(&(UIP_IP_BUF->srcipaddr), &(UIP_IP_BUF->destipaddr), UIP_HTONS(UIP_IP_BUF->destport),
-                             UIP_HTONS(UIP_IP_BUF->srcport), uip_appdata - 4, uip_datalen() - (UIP_LLH_LEN + UIP_IPH_LEN + 16));
+        } else {
+            PRINTF("R: Forwarding %s\n", driver->name);
+            send_packet_driver(driver, flow, &(UIP_IP_BUF->srcipaddr), &(UIP_IP_BUF->destipaddr),
+                               UIP_HTONS(UIP_IP_BUF->destport), UIP_HTONS(UIP_IP_BUF->srcport), uip_appdata - 4,
+                               uip_datalen() - (UIP_LLH_LEN + UIP_IPH_LEN + 16), 1, 0);
             leds_on(WIFI_FORWARD_LED);
             return 0;
         }
@@ -774,27 +1121,25 @@ int heterogeneous_udp_sendto(struct uip_udp_conn *c, const void *data, uint8_t l
     }
 
     if (flow) {
-        flow->validity = FLOW_VALIDITY;
-        if (flow->flags & PND) {    // need to ask for route (pending flag active)
-            PROCESS_CONTEXT_BEGIN(&serial_connection);
-            ask_for_route(flow);
-            PROCESS_CONTEXT_END();
+        refresh_flow(flow);
+        retry_pending(flow);
+        if ((flow->flags & PND) &&    // need to ask for route (pending flag active), packet waits for answer
+            hold_packet(flow, PENDING_UDP, c, &src_ip, toaddr, UIP_HTONS(c->rport), UIP_HTONS(c->lport), toport,
+                        data, len)) {
+            flow->flags |= UP;
+            return 0;
         }
-        if (flow->technology == RPL_TECHNOLOGY || !(flow->flags & CNF)) {    //dst tech is wifi or not approved wifi
+        const tech_driver *driver = packet_driver(flow);
+        if (driver == NULL) {    //dst tech is rpl or not approved wifi
 //            simple_udp_sendto(c, data, datalen, to);
             uip_udp_packet_sendto(c, data, len, toaddr, toport);
             leds_on(RPL_SEND_LED);
-            inc_sent_rpl();
-#ifdef HETEROGENEOUS_STATISTICS
-            stats.rpl_sent++;
-#endif
-        } else if (flow->technology == WIFI_TECHNOLOGY && (flow->flags & CNF == 1)) {
-            send_packet_wifi(&src_ip, toaddr, UIP_HTONS(c->rport), UIP_HTONS(c->lport), data, len);
+            inc_sent_rpl(len);
+            statistics_sent(flow, RPL_TECHNOLOGY, len, 0, 0);
+        } else {
+            send_packet_driver(driver, flow, &src_ip, toaddr, UIP_HTONS(c->rport), UIP_HTONS(c->lport), data, len,
+                               0, 0);
             leds_on(WIFI_SEND_LED);
-            inc_wifi_sent();
-#ifdef HETEROGENEOUS_STATISTICS
-            stats.wifi_sent++;
-#endif
         }
         flow->flags |= UP;
     }
@@ -871,16 +1216,6 @@ void print_mode() {
     printf("!c%d\n", device_mode);
 }
 
-#ifdef HETEROGENEOUS_STATISTICS
-/**
- * Prints mote statistics about data sending
- */
-void print_statistics_table() {
-    printf("Rpl forwarded from rpl: %d\nRpl forwarded from Wifi: %d\nRpl sent: %d\nWifi forwarded from RPL: %d\nWifi forwarded from WiFi: %d\nWifi sent: %d\n",
-           stats.rpl_forwarded_rpl, stats.rpl_forwarded_wifi, stats.rpl_sent, stats.wifi_forwarded_rpl, stats.wifi_forwarded_wifi, stats.rpl_sent);
-}
-#endif
-
 /**
  * Returns node source global IPv6 address
  * @return
@@ -905,13 +1240,17 @@ void init_module(uint8_t mode, const uip_ipaddr_t *ip) {
 
     uip_ipaddr_copy(&src_ip, ip);
     set_callback(heterogeneous_forwarding_callback);
+    flow_table_init();
     device_mode = mode;
 
     printf("!b\n");
     print_src_ip();
     print_neighbours();
 
+    register_technology(&rpl_driver);
     add_metrics(RPL_TECHNOLOGY, DEFAULT_RPL_EN, DEFAULT_RPL_BW, DEFAULT_RPL_ETX);
+    serial_frame_init();
+    energy_model_init();
     process_start(&serial_connection, NULL);
     process_start(&blinker, NULL);
     process_start(&purger, NULL);
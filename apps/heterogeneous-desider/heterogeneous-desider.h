@@ -7,6 +7,7 @@
 #define CONTIKI_HETEROGENEOUS_DESIDER_H
 
 #include "net/ip/uip.h"
+#include "net/ip/simple-udp.h"
 
 #ifdef COAP_HETEROGENEOUS
 #include "er-coap.h"
@@ -18,8 +19,54 @@
 #define WIFI_TECHNOLOGY 1
 #define RPL_TECHNOLOGY 2
 
+#ifdef HETEROGENEOUS_CONF_MAX_TECHNOLOGIES
+#define MAX_TECHNOLOGIES HETEROGENEOUS_CONF_MAX_TECHNOLOGIES
+#else
 #define MAX_TECHNOLOGIES 2
+#endif
+
+/**
+ * Set HETEROGENEOUS_CONF_SPLIT_FLOWS to split packets of one flow across technologies with similar cost, in proportion
+ * to their capacity
+ */
+#ifdef HETEROGENEOUS_CONF_SPLIT_FLOWS
+#define SPLIT_FLOWS HETEROGENEOUS_CONF_SPLIT_FLOWS
+#else
+#define SPLIT_FLOWS 0
+#endif
+
+/**
+ * Technology is used for split flow when its cost is at most SPLIT_TOLERANCE percent higher than cost of best one
+ */
+#ifdef HETEROGENEOUS_CONF_SPLIT_TOLERANCE
+#define SPLIT_TOLERANCE HETEROGENEOUS_CONF_SPLIT_TOLERANCE
+#else
+#define SPLIT_TOLERANCE 25
+#endif
+
+#ifdef HETEROGENEOUS_CONF_RPL_CAPACITY
+#define RPL_CAPACITY HETEROGENEOUS_CONF_RPL_CAPACITY
+#else
+#define RPL_CAPACITY 50
+#endif
+
+#ifdef HETEROGENEOUS_CONF_WIFI_CAPACITY
+#define WIFI_CAPACITY HETEROGENEOUS_CONF_WIFI_CAPACITY
+#else
+#define WIFI_CAPACITY 100
+#endif
+
+#ifdef HETEROGENEOUS_CONF_MAX_FLOWS
+#define MAX_FLOWS HETEROGENEOUS_CONF_MAX_FLOWS
+#else
 #define MAX_FLOWS 6
+#endif
+
+#ifdef HETEROGENEOUS_CONF_DECISION_CACHE_SIZE
+#define DECISION_CACHE_SIZE HETEROGENEOUS_CONF_DECISION_CACHE_SIZE
+#else
+#define DECISION_CACHE_SIZE 8
+#endif
 
 #define MODE_ROOT 1
 #define MODE_NODE 2
@@ -55,26 +102,45 @@ extern const int SIMULATED_BAT_CAPACITY;
 
 #ifdef HETEROGENEOUS_STATISTICS
 /**
- * Simple structure for handling basic database
+ * Latency histogram has log2 bins of clock ticks: bin 0 counts packets sent without delay, bin i counts delays from
+ * 2^(i-1) to 2^i - 1 ticks, last bin counts all longer delays
  */
-struct statistics {
-    short rpl_sent;
-    short rpl_forwarded_rpl;
-    short rpl_forwarded_wifi;
-    short wifi_sent;
-    short wifi_forwarded_rpl;
-    short wifi_forwarded_wifi;
-} statistics;
+#ifdef HETEROGENEOUS_CONF_STATISTICS_LATENCY_BINS
+#define STATISTICS_LATENCY_BINS HETEROGENEOUS_CONF_STATISTICS_LATENCY_BINS
+#else
+#define STATISTICS_LATENCY_BINS 12
 #endif
 
 /**
- * Structure defines technology unit
+ * Counters of one technology
  */
-typedef struct tech_struct {
-    struct tech_struct *next;
-    uint8_t type;
-} tech_struct;
+typedef struct tech_statistics {
+    uint8_t technology;
+    uint32_t packets;       // packets sent or forwarded using technology
+    uint32_t forwarded;     // packets of other nodes included in packets
+    uint32_t bytes;
+    uint32_t drops;
+    uint16_t latency[STATISTICS_LATENCY_BINS];
+} tech_statistics;
+
+/**
+ * Counters of one flow, they live as long as the flow
+ */
+typedef struct flow_statistics {
+    uint32_t packets;
+    uint32_t bytes;
+    uint32_t pending;       // clock ticks packets of flow spent waiting for route answer
+    uint16_t drops;
+    uint16_t queries;       // route questions sent to linux device
+    uint16_t timeouts;      // route questions not answered in time
+    uint16_t rtt;           // round-trip time of last answered route question in clock ticks
+} flow_statistics;
+#endif
 
+/**
+ * Validity of metrics and flows in seconds. Entries store time of last refresh, metrics list and flow table are kept
+ * ordered by it, so the entry which expires first is always at one end.
+ */
 #define METRICS_VALIDITY 50
 
 /**
@@ -82,7 +148,7 @@ typedef struct tech_struct {
  */
 typedef struct metrics_struct {
     struct metrics_struct *next;
-    uint8_t validity;
+    clock_time_t refreshed;
     uint8_t technology;
     uint8_t energy;
     uint8_t bandwidth;
@@ -92,30 +158,96 @@ typedef struct metrics_struct {
 #define FLOW_VALIDITY 255
 
 /**
- * flags structure -> |x|x|x|x|x|UP|PND|CNF
+ * flags structure -> |x|x|x|ASK|ANN|UP|PND|CNF
  * CNF -> if flow was confirmed by linux device (used by wifi technology)
  * PND -> pending, if contiki waits for response to confirmation
  * UP -> decision was made on packet send/forwarding upward
+ * ANN -> flow addresses were announced to linux device in binary serial mode, packets may carry flow id only
+ * ASK -> route question of pending flow was sent and is not answered yet, cleared with PND when answered; kept
+ *        without PND after timeout until PENDING_BACKOFF passes and flow becomes pending again
  */
 #define CNF 0x01
 #define PND 0x02
 #define UP 0x04
+#define ANN 0x08
+#define ASK 0x10
 
 /**
  * Structure that represents flow
  */
 typedef struct flow_struct {
     struct flow_struct *next;
+    struct flow_struct *prev;
     uint8_t flow_id;
     uip_ipaddr_t to;
     uint8_t energy;
     uint8_t bandwidth;
     uint8_t etx;
-    uint8_t validity;
-    struct tech_struct *technology;
+    clock_time_t refreshed;
+    uint16_t generation;    // metrics generation technology was selected in
+    uint8_t technology;
+    uint8_t split_counter;
     char flags;
+    clock_time_t asked;     // when route question of pending flow was sent
+#ifdef HETEROGENEOUS_STATISTICS
+    flow_statistics stats;
+#endif
 } flow_struct;
 
+/**
+ * Packet handed to technology driver, ports have same byte order as in serial protocol
+ */
+typedef struct tech_packet {
+    flow_struct *flow;
+    const uip_ipaddr_t *from;
+    const uip_ipaddr_t *to;
+    uint16_t remote_port;
+    uint16_t src_port;
+    const void *data;
+    uint16_t len;
+} tech_packet;
+
+/**
+ * driver flags
+ * TECH_F_CONFIRM -> flows must be confirmed (CNF flag) before packets are sent using technology
+ * TECH_F_STATIC -> metrics of technology do not expire
+ */
+#define TECH_F_CONFIRM 0x01
+#define TECH_F_STATIC 0x02
+
+/**
+ * Technology driver. RPL mesh is registered as driver without send function, packets are sent by caller of desider.
+ * capacity is available bandwidth in kbit/s used for splitting flows, energy is energy cost per packet.
+ */
+typedef struct tech_driver {
+    const char *name;
+    uint8_t type;
+    uint8_t flags;
+    uint16_t capacity;
+    uint16_t energy;
+    /**
+     * Sends packet, returns nonzero if packet was sent
+     */
+    int (*send)(const struct tech_driver *driver, const tech_packet *packet);
+    /**
+     * Cost model, lower is better. NULL uses weighted sum of metrics
+     */
+    int (*cost)(const struct tech_driver *driver, const metrics_struct *metrics, uint8_t k_en, uint8_t k_bw,
+                uint8_t k_etx);
+} tech_driver;
+
+/**
+ * Structure defines technology unit
+ */
+typedef struct tech_struct {
+    struct tech_struct *next;
+    uint8_t type;
+    const tech_driver *driver;
+} tech_struct;
+
+extern const tech_driver rpl_driver;
+extern const tech_driver wifi_driver;
+
 /**
  * \brief       Adds technology to technology table
  * @param type
@@ -123,6 +255,13 @@ typedef struct flow_struct {
  */
 tech_struct *add_technology(uint8_t type);
 
+/**
+ * \brief       Registers technology driver, may be called at any time
+ * @param driver
+ * @return
+ */
+tech_struct *register_technology(const tech_driver *driver);
+
 /**
  * \brief       Adds metrics to metrics table
  *
@@ -133,6 +272,80 @@ tech_struct *add_technology(uint8_t type);
  */
 metrics_struct * add_metrics(uint8_t technology, uint8_t energy, uint8_t bandwidth, uint8_t etx);
 
+/**
+ * \brief       Sets energy metric of technology, validity of metrics is not renewed
+ * @param technology
+ * @param energy
+ */
+void set_metrics_energy(uint8_t technology, uint8_t energy);
+
+void inc_wifi_sent(uint16_t len);
+void inc_sent_rpl(uint16_t len);
+
 extern tech_struct *find_tech_by_type(uint8_t type);
 
+metrics_struct *find_metrics_by_tech_type(uint8_t type);
+
+/**
+ * \brief       Selects technology for metric keys, decisions are cached until metrics change
+ * @param k_en
+ * @param k_bw
+ * @param k_etx
+ * @return
+ */
+uint8_t select_technology(uint8_t k_en, uint8_t k_bw, uint8_t k_etx);
+
+/**
+ * \brief       Finds flow by its flow ID
+ */
+flow_struct *find_flow_by_id(uint8_t id);
+
+/**
+ * \brief       Renews flow validity and marks flow as recently used
+ */
+void refresh_flow(flow_struct *flow);
+
+/**
+ * \brief       Removes expired flows and metrics
+ * @return      time until next entry expires, 0 if no entry expires
+ */
+clock_time_t purge_expired(void);
+
+/**
+ * \brief       Clears announced flag of all flows
+ */
+void clear_flow_announcements();
+
+/**
+ * \brief       Initializes desider, registers RPL technology and starts serial connection with linux device
+ * @param mode  MODE_ROOT or MODE_NODE
+ * @param ip    global address of node
+ */
+void init_module(uint8_t mode, const uip_ipaddr_t *ip);
+
+flow_struct *find_flow(const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint8_t etx);
+flow_struct *find_best_flow(const uip_ipaddr_t *to, uint8_t en, uint8_t bw, uint8_t etx);
+flow_struct *add_flow(const uip_ipaddr_t *to, uint8_t tech, uint8_t en, uint8_t bw, uint8_t etx);
+void fill_keys(const void *data, uint16_t len, uint8_t *en, uint8_t *bw, uint8_t *etx);
+void renew_metrics_validity(uint8_t type);
+uip_ipaddr_t *get_my_ip();
+
+void print_tech_table();
+void print_energy_counter();
+void print_metrics_table();
+void print_flow_table();
+void print_neighbours();
+void print_src_ip();
+void print_mode();
+
+#ifdef SIMPLE_UDP_HETEROGENEOUS
+int heterogenous_simple_udp_sendto(struct simple_udp_connection *c, const void *data, uint16_t datalen,
+                                   const uip_ipaddr_t *to);
+int heterogenous_udp_register(struct simple_udp_connection *c, uint16_t local_port, uip_ipaddr_t *remote_addr,
+                              uint16_t remote_port, simple_udp_callback receive_callback);
+void heterogenous_udp_callback(struct simple_udp_connection *c, const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+                               const uip_ipaddr_t *receiver_addr, uint16_t receiver_port, const uint8_t *data,
+                               uint16_t datalen);
+#endif
+
 #endif //CONTIKI_HETEROGENEOUS_DESIDER_H
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+#define DEBUG 0
+#include "net/ip/uip-debug.h"
+
+#include "pending.h"
+#include "statistics.h"
+
+#include "contiki.h"
+#include "sys/ctimer.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+
+#include <string.h>
+
+LIST(pending_list);
+MEMB(pending_memb, struct pending_packet, PENDING_PACKETS);
+
+static struct ctimer pending_timer;
+
+static void pending_expired(void *ptr);
+
+/**
+ * Schedules timer for deadline of oldest packet, list is ordered by arrival, so head expires first
+ */
+static void schedule_timer() {
+    pending_packet *p = list_head(pending_list);
+    clock_time_t elapsed;
+
+    if (p == NULL) {
+        ctimer_stop(&pending_timer);
+        return;
+    }
+    elapsed = clock_time() - p->queued;
+    ctimer_set(&pending_timer, elapsed < PENDING_TIMEOUT ? PENDING_TIMEOUT - elapsed : 0, pending_expired, NULL);
+}
+
+/**
+ * Removes packet from queue and sends it
+ *
+ * @param p
+ */
+static void release(pending_packet *p) {
+    list_remove(pending_list, p);
+    send_pending_packet(p);
+    memb_free(&pending_memb, p);
+}
+
+/**
+ * Route question was not answered in time, flows of expired packets stop waiting and their packets go using RPL. ASK
+ * stays set, so flow asks again when PENDING_BACKOFF passes since timeout.
+ *
+ * @param ptr
+ */
+static void pending_expired(void *ptr) {
+    pending_packet *p;
+    flow_struct *flow;
+
+    while ((p = list_head(pending_list)) != NULL && (clock_time_t)(clock_time() - p->queued) >= PENDING_TIMEOUT) {
+        PRINTF("Route question for flow %d timed out\n", p->flow_id);
+        flow = find_flow_by_id(p->flow_id);
+        if (flow && uip_ipaddr_cmp(&flow->to, &p->to)) {
+            statistics_query_timeout(flow);
+            flow->flags &= ~PND;
+            flow->asked = clock_time();
+            pending_flush(flow);
+        }
+        else {
+            release(p);
+        }
+    }
+    schedule_timer();
+}
+
+/**
+ * Holds copy of packet, packet is not queued when it is too long or queue of flow is full
+ *
+ * @return
+ */
+uint8_t pending_enqueue(flow_struct *flow, uint8_t kind, void *conn, const uip_ipaddr_t *from, const uip_ipaddr_t *to,
+                        uint16_t remote_port, uint16_t src_port, uint16_t rpl_port, const void *data, uint16_t len) {
+    pending_packet *p;
+    uint8_t count;
+
+    if (len > PENDING_MAX_LEN)
+        return PENDING_NOT_QUEUED;
+
+    count = pending_held(flow);
+    if (count >= PENDING_PER_FLOW)
+        return PENDING_NOT_QUEUED;
+
+    p = memb_alloc(&pending_memb);
+    if (p == NULL)
+        return PENDING_NOT_QUEUED;
+
+    p->kind = kind;
+    p->flow_id = flow->flow_id;
+    p->conn = conn;
+    uip_ipaddr_copy(&p->from, from);
+    uip_ipaddr_copy(&p->to, to);
+    p->remote_port = remote_port;
+    p->src_port = src_port;
+    p->rpl_port = rpl_port;
+    p->queued = clock_time();
+    p->len = len;
+    memcpy(p->data, data, len);
+
+    list_add(pending_list, p);
+    if (list_head(pending_list) == p)
+        schedule_timer();
+
+    PRINTF("Holding packet %d for flow %d\n", count + 1, flow->flow_id);
+    return count == 0 ? PENDING_QUEUED_FIRST : PENDING_QUEUED;
+}
+
+uint8_t pending_held(const flow_struct *flow) {
+    pending_packet *p;
+    uint8_t count = 0;
+
+    for (p = list_head(pending_list); p != NULL; p = list_item_next(p)) {
+        if (p->flow_id == flow->flow_id)
+            count++;
+    }
+    return count;
+}
+
+uint8_t pending_count(void) {
+    return list_length(pending_list);
+}
+
+/**
+ * Sends all packets held for flow in order they were queued
+ *
+ * @param flow
+ */
+void pending_flush(flow_struct *flow) {
+    pending_packet *p, *next;
+    uint8_t head_removed = 0;
+
+    for (p = list_head(pending_list); p != NULL; p = next) {
+        next = list_item_next(p);
+        if (p->flow_id == flow->flow_id && uip_ipaddr_cmp(&flow->to, &p->to)) {
+            head_removed |= (p == list_head(pending_list));
+            release(p);
+        }
+    }
+    if (head_removed)
+        schedule_timer();
+}
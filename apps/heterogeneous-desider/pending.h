@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+
+#ifndef CONTIKI_HETEROGENEOUS_PENDING_H
+#define CONTIKI_HETEROGENEOUS_PENDING_H
+
+#include "heterogeneous-desider.h"
+#include "sys/clock.h"
+
+/**
+ * Packets of flows waiting for route question answer (PND flag) are held in bounded queue until linux device answers,
+ * then they are sent in burst using selected technology. Packets not answered within PENDING_TIMEOUT are sent using
+ * RPL and flow uses RPL until PENDING_BACKOFF passes, then route is asked again.
+ */
+#ifdef HETEROGENEOUS_CONF_PENDING_PACKETS
+#define PENDING_PACKETS HETEROGENEOUS_CONF_PENDING_PACKETS
+#else
+#define PENDING_PACKETS 8
+#endif
+
+#ifdef HETEROGENEOUS_CONF_PENDING_PER_FLOW
+#define PENDING_PER_FLOW HETEROGENEOUS_CONF_PENDING_PER_FLOW
+#else
+#define PENDING_PER_FLOW 4
+#endif
+
+#ifdef HETEROGENEOUS_CONF_PENDING_MAX_LEN
+#define PENDING_MAX_LEN HETEROGENEOUS_CONF_PENDING_MAX_LEN
+#else
+#define PENDING_MAX_LEN 96
+#endif
+
+#ifdef HETEROGENEOUS_CONF_PENDING_TIMEOUT
+#define PENDING_TIMEOUT HETEROGENEOUS_CONF_PENDING_TIMEOUT
+#else
+#define PENDING_TIMEOUT CLOCK_SECOND
+#endif
+
+#ifdef HETEROGENEOUS_CONF_PENDING_BACKOFF
+#define PENDING_BACKOFF HETEROGENEOUS_CONF_PENDING_BACKOFF
+#else
+#define PENDING_BACKOFF (10 * CLOCK_SECOND)
+#endif
+
+/**
+ * How packet is sent using RPL
+ */
+#define PENDING_SIMPLE_UDP 1
+#define PENDING_UDP 2
+#define PENDING_FORWARD 3
+
+/**
+ * enqueue results
+ */
+#define PENDING_NOT_QUEUED 0
+#define PENDING_QUEUED 1
+#define PENDING_QUEUED_FIRST 2
+
+typedef struct pending_packet {
+    struct pending_packet *next;
+    uint8_t kind;
+    uint8_t flow_id;
+    void *conn;
+    uip_ipaddr_t from;
+    uip_ipaddr_t to;
+    uint16_t remote_port;       // ports as passed to technology driver
+    uint16_t src_port;
+    uint16_t rpl_port;          // destination port for PENDING_UDP
+    clock_time_t queued;
+    uint16_t len;
+    uint8_t data[PENDING_MAX_LEN];
+} pending_packet;
+
+/**
+ * \brief       Holds copy of packet for flow, returns PENDING_QUEUED_FIRST for first packet of flow
+ */
+uint8_t pending_enqueue(flow_struct *flow, uint8_t kind, void *conn, const uip_ipaddr_t *from, const uip_ipaddr_t *to,
+                        uint16_t remote_port, uint16_t src_port, uint16_t rpl_port, const void *data, uint16_t len);
+
+/**
+ * \brief       Returns number of packets held for flow
+ */
+uint8_t pending_held(const flow_struct *flow);
+
+/**
+ * \brief       Returns number of packets held
+ */
+uint8_t pending_count(void);
+
+/**
+ * \brief       Sends all packets held for flow, called when route question is answered
+ */
+void pending_flush(flow_struct *flow);
+
+/**
+ * \brief       Sends held packet using technology selected by its flow or using RPL (implemented by desider)
+ */
+void send_pending_packet(pending_packet *p);
+
+#endif //CONTIKI_HETEROGENEOUS_PENDING_H
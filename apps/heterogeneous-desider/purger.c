@@ -7,36 +7,64 @@
 #include "net/ip/uip-debug.h"
 #include "heterogeneous-desider.h"
 #include "purger.h"
+#include "energy-model.h"
 
 #include "contiki.h"
 
 PROCESS(purger, "purger");
 
-uint8_t counter = 0;
+static struct etimer expiry_timer;
 
+/**
+ * Wakes purger to plan expiration of new or refreshed entry, when expiry timer is not running or is set for later
+ * time than the entry expires
+ *
+ * @param validity validity of entry in seconds
+ */
+void purger_schedule(unsigned long validity) {
+    clock_time_t remaining;
+
+    if (etimer_expired(&expiry_timer)) {
+        process_poll(&purger);
+        return;
+    }
+    remaining = etimer_expiration_time(&expiry_timer) - clock_time();
+    if (validity * CLOCK_SECOND < remaining) {
+        process_poll(&purger);
+    }
+}
+
+/**
+ * Purger sleeps until next flow or metrics entry expires, it does not wake when nothing can expire. Independently it
+ * asks linux device for wifi metrics and updates energy model every METRICS_REFRESH_INTERVAL.
+ */
 PROCESS_THREAD(purger, ev, data)
 {
+    static struct etimer refresh_timer;
+    clock_time_t next;
+
     PROCESS_BEGIN();
     PRINTF("Starting purger\n");
 
-    static struct etimer timer;
-    etimer_set(&timer ,CLOCK_SECOND * PURGE_INTERVAL);
-
+    etimer_set(&refresh_timer, CLOCK_SECOND * METRICS_REFRESH_INTERVAL);
+    process_poll(&purger);
 
     while(1) {
-        PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
-        etimer_set(&timer ,CLOCK_SECOND * PURGE_INTERVAL);
-
-
-        purge_flows();
-        purge_metrics();
-
-        counter+=PURGE_INTERVAL;
+        PROCESS_WAIT_EVENT();
 
-        if (counter >= METRICS_VALIDITY/5) {
+        if (ev == PROCESS_EVENT_TIMER && data == &refresh_timer) {
+            etimer_reset(&refresh_timer);
+            energy_model_update();
             printf("?w\n");
-            counter = 0;
+        } else if (ev == PROCESS_EVENT_POLL || (ev == PROCESS_EVENT_TIMER && data == &expiry_timer)) {
+            next = purge_expired();
+            if (next) {
+                PRINTF("Next entry expires in %lu ticks\n", (unsigned long) next);
+                etimer_set(&expiry_timer, next);
+            } else {
+                etimer_stop(&expiry_timer);
+            }
         }
     }
     PROCESS_END();
-}
\ No newline at end of file
+}
@@ -7,9 +7,17 @@
 #ifndef CONTIKI_HETEROGENEOUS_PURGER_H
 #define CONTIKI_HETEROGENEOUS_PURGER_H
 
-#define PURGE_INTERVAL 5
+/**
+ * Interval of asking linux device for wifi metrics in seconds
+ */
+#define METRICS_REFRESH_INTERVAL (METRICS_VALIDITY / 5)
 
 PROCESS_NAME(purger);
 
-#endif //CONTIKI_HETEROGENEOUS_PURGER_H
+/**
+ * \brief       Plans expiration of newly added or refreshed entry
+ * @param validity validity of entry in seconds
+ */
+void purger_schedule(unsigned long validity);
 
+#endif //CONTIKI_HETEROGENEOUS_PURGER_H
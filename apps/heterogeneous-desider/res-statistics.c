@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+/**
+ * CoAP resource with statistics dump of desider (see statistics.h), activate it by
+ * rest_activate_resource(&res_statistics, "desider/stats"). Dump is longer than one block, so it is sent using
+ * blockwise transfer.
+ */
+
+#include "contiki.h"
+
+#if defined(HETEROGENEOUS_STATISTICS) && defined(COAP_HETEROGENEOUS)
+#include "rest-engine.h"
+#include "statistics.h"
+
+#include <string.h>
+
+/**
+ * Window of dump requested by client
+ */
+typedef struct block_writer {
+    uint8_t *buffer;
+    int32_t offset;
+    uint16_t size;
+    int32_t position;
+    uint16_t len;
+} block_writer;
+
+static void res_get_handler(void *request, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset);
+
+RESOURCE(res_statistics,
+         "title=\"Desider statistics\";ct=42",
+         res_get_handler,
+         NULL,
+         NULL,
+         NULL);
+
+/**
+ * Copies part of chunk which falls into requested window
+ */
+static void write_block(const uint8_t *data, uint16_t len, void *ptr) {
+    block_writer *w = ptr;
+    int32_t start = w->position;
+
+    w->position += len;
+    if (w->position <= w->offset || start >= w->offset + w->size)
+        return;
+    if (start < w->offset) {
+        data += w->offset - start;
+        len -= w->offset - start;
+        start = w->offset;
+    }
+    if (start + len > w->offset + w->size)
+        len = w->offset + w->size - start;
+    memcpy(w->buffer + (start - w->offset), data, len);
+    w->len += len;
+}
+
+static void res_get_handler(void *request, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset) {
+    block_writer w = { buffer, *offset, preferred_size, 0, 0 };
+    uint16_t total = statistics_dump(write_block, &w);
+
+    if (*offset >= total) {
+        const char *error_msg = "BlockOutOfScope";
+
+        REST.set_response_status(response, REST.status.BAD_OPTION);
+        REST.set_response_payload(response, error_msg, strlen(error_msg));
+        return;
+    }
+
+    REST.set_header_content_type(response, REST.type.APPLICATION_OCTET_STREAM);
+    REST.set_response_payload(response, buffer, w.len);
+    *offset += w.len;
+    if (*offset >= total)
+        *offset = -1;
+}
+#endif
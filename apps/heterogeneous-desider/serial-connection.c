@@ -7,12 +7,18 @@
 #include "net/ip/uip-debug.h"
 
 #include "serial-connection.h"
+#include "serial-frame.h"
+#include "pending.h"
+#include "statistics.h"
+#include "energy-model.h"
 #include "heterogeneous-desider.h"
 
 #include "contiki.h"
 #include "dev/serial-line.h"
+#include "dev/leds.h"
 #include "net/ip/simple-udp.h"
 #include "net/ip/uip.h"
+#include "net/ip/uip-udp-packet.h"
 #include "lib/memb.h"
 #include "lib/list.h"
 
@@ -22,9 +28,13 @@
 #include <stdlib.h>
 
 
-static uint8_t payload[70];       // ToDo refactor buff size -> size must be identical with uip_buff - headers
+/**
+ * Packets from wifi side are decoded directly into payload area of uip_buf, so forwarding does not copy them and
+ * payload size is limited only by UIP_BUFSIZE
+ */
+static uint8_t *const payload = UIP_UDP_PACKET_PAYLOAD;
 uint16_t sport, dport;
-static short payload_len;
+static uint16_t payload_len;
 static uip_ipaddr_t sender_ip, receiver_ip;
 struct simple_udp_connection *c = NULL;
 
@@ -58,17 +68,20 @@ static uint8_t unit_from_char(char c)
  */
 void hex_string_to_value(char *hex_string)
 {
-    uint8_t *result;
-    uint8_t *p, len, i;
+    uint8_t *p;
+    uint16_t len, i;
 
     len = strlen(hex_string) / 2;
+    if (len > UIP_UDP_PACKET_MAX_PAYLOAD) {
+        PRINTF("Payload too long, truncating\n");
+        len = UIP_UDP_PACKET_MAX_PAYLOAD;
+    }
 
     for(i=0, p = (uint8_t *) hex_string; i<len; i++) {
         payload[i] = (unit_from_char(*p) << 4) | unit_from_char(*(p+1));
         p += 2;
     }
     payload_len = len;
-    return result;
 }
 
 /**
@@ -130,7 +143,7 @@ uip_ipaddr_t *string_ipv6_to_uip_ipaddr(char *ip_string, uip_ipaddr_t *ipv6) {
  * @return
  */
 uint8_t parse_incoming_packet(char *data, int len, uint16_t *sport, uint16_t *dport, struct simple_udp_connection *c,
-                            char *payload, int *payload_len, uip_ipaddr_t *sender_ip, uip_ipaddr_t *receiver_ip, int i) {
+                            uint8_t *payload, uint16_t *payload_len, uip_ipaddr_t *sender_ip, uip_ipaddr_t *receiver_ip, int i) {
     char *end_str, *token = strtok_r(data, ";", &end_str);
     uint8_t meta;
 
@@ -191,7 +204,7 @@ uint8_t parse_int_from_string(char *data, int *i, uint8_t start, uint8_t len) {
                 strncpy (string, data + (start*sizeof(char)), (j - start));
                 string[j-start] = '\0';
                 *i = j-1;
-                return strtol(string, &string, 10);;
+                return strtol(string, NULL, 10);
             }
             else {
                 return 0;
@@ -201,9 +214,103 @@ uint8_t parse_int_from_string(char *data, int *i, uint8_t start, uint8_t len) {
     return 0;
 }
 
+/**
+ * Delivers packet stored in payload buffer to upper layer
+ */
+static void deliver_packet() {
+#ifdef SIMPLE_UDP_HETEROGENEOUS
+    heterogenous_udp_callback(c, &sender_ip, sport, &receiver_ip, dport, payload, payload_len);
+#endif
+#ifdef COAP_HETEROGENEOUS
+    PRINTF("Delivering packet to COAP from Wifi\n");
+    coap_receive_params(payload_len, payload, sport, sender_ip);
+#endif
+}
+
+/**
+ * Forwards packet stored in payload buffer using RPL
+ */
+static void forward_packet() {
+    uint8_t k_en, k_bw, k_etx;
+    fill_keys(payload, payload_len, &k_en, &k_bw, &k_etx);
+
+    flow_struct *flow = find_flow(&receiver_ip, k_en, k_bw, k_etx);
+
+    if (!flow) {
+        PRINTF("F: Flow not found, creating new one\n");
+        flow = add_flow(&receiver_ip, RPL_TECHNOLOGY, k_en, k_bw, k_etx);
+    }
+
+    refresh_flow(flow);
+    PRINTF("Forwarding packet from WIFI using RPL: ");
+    PRINT6ADDR(&receiver_ip);
+    PRINTF("\n");
+
+    uip_udp_packet_forward(&sender_ip, &receiver_ip, sport, dport, payload, payload_len);
+    leds_on(RPL_FORWARD_LED);
+    inc_sent_rpl(payload_len);
+    statistics_sent(flow, RPL_TECHNOLOGY, payload_len, 1, 0);
+}
+
+/**
+ * Answers route question for packet stored in payload buffer, packet is forwarded using RPL if destination is not
+ * reachable by wifi
+ *
+ * @param question_id
+ */
+static void answer_route_request(int question_id) {
+    uint8_t k_en, k_bw, k_etx;
+    fill_keys(payload, payload_len, &k_en, &k_bw, &k_etx);
+    flow_struct *flow = find_flow(&receiver_ip, k_en, k_bw, k_etx);
+
+    PRINTF("W: forwarding callback called for packet from: ");
+    PRINT6ADDR(&sender_ip);
+    PRINTF(" to: ");
+    PRINT6ADDR(&receiver_ip);
+    PRINTF(" data: %s\n", payload);
+
+    if (!flow) {
+        PRINTF("W: Flow not found, creating new one\n");
+        uint8_t dst_technology = select_technology(k_en, k_bw, k_etx);
+        flow = add_flow(&receiver_ip, dst_technology, k_en, k_bw, k_etx);
+    }
+
+    if (flow) {
+        refresh_flow(flow);
+        PRINTF("W: flow flags: %d\n", flow->flags);
+        if (flow->technology == RPL_TECHNOLOGY) {
+            printf("$p;%d;0;\n", question_id);
+            forwarding_semafor = 1;
+            uip_udp_packet_forward(&sender_ip, &receiver_ip, sport, dport, payload, payload_len);
+            leds_on(RPL_FORWARD_LED);
+            statistics_sent(flow, RPL_TECHNOLOGY, payload_len, 1, 0);
+
+        } else {
+            printf("$p;%d;1;\n", question_id);
+            leds_on(WIFI_FORWARD_LED);
+            flow->flags &= ~(PND | ASK);
+            flow->flags |= CNF;
+        }
+    }
+
+    flow_struct *src_flow = find_flow(&sender_ip, k_en, k_bw, k_etx);         // source flow
+
+    if (!src_flow) {
+        PRINTF("W: Creating new src flow\n");
+        src_flow = add_flow(&sender_ip, WIFI_TECHNOLOGY, k_en, k_bw, k_etx);
+    }
+    else if (src_flow->technology != WIFI_TECHNOLOGY) {
+        PRINTF("W: Marking src flow as WIFI\n");
+        src_flow->technology = WIFI_TECHNOLOGY;
+    }
+    src_flow->flags &= ~(PND | ASK);
+    src_flow->flags |= CNF;
+}
+
 /**
  * Handles commands sent over serial
  * w -> register wifi technology with metrics
+ * m -> switch serial mode (0 -> ASCII, 1 -> binary frames, 2 -> batched binary frames)
  * p -> deliver packet to mote
  * f -> request to forward packet using rpl
  *
@@ -214,10 +321,12 @@ uint8_t parse_int_from_string(char *data, int *i, uint8_t start, uint8_t len) {
 int handle_commands(char *data, uint8_t len) {
     PRINTF("Handling command %c\n", data[1]);
     if (data[1] == 'w') {
-        metrics_struct *rpl_metrics = add_metrics(RPL_TECHNOLOGY, DEFAULT_RPL_EN, DEFAULT_RPL_BW, DEFAULT_RPL_ETX);
+        metrics_struct *rpl_metrics = add_metrics(RPL_TECHNOLOGY, energy_model_energy(RPL_TECHNOLOGY, DEFAULT_RPL_EN),
+                                                  DEFAULT_RPL_BW, DEFAULT_RPL_ETX);
 
-        tech_struct *wifi_tech = add_technology(WIFI_TECHNOLOGY);
-        uint8_t i, en = 0, bw = 0, etx = 0;
+        register_technology(&wifi_driver);
+        int i;
+        uint8_t en = 0, bw = 0, etx = 0;
 
         for (i=2;i <= len; i++) {
             if (data[i] == 'e') {
@@ -230,7 +339,8 @@ int handle_commands(char *data, uint8_t len) {
                 etx = parse_int_from_string(data, &i, i+1, len);
             }
         }
-        add_metrics(WIFI_TECHNOLOGY, en, bw, etx);
+        // energy reported by linux device is used only until energy model knows cost of wifi
+        add_metrics(WIFI_TECHNOLOGY, energy_model_energy(WIFI_TECHNOLOGY, en), bw, etx);
         wr_rate = en/rpl_metrics->energy;
         sent_wifi = 0;
         sent_rpl = 0;
@@ -239,36 +349,23 @@ int handle_commands(char *data, uint8_t len) {
     } else if (data[1] == 'p') {    // DELIVERY PACKET FROM WIFI PART
 //        payload_len = 0;
         clear_buff();
-        parse_incoming_packet(data, len, &sport, &dport, c, &payload, &payload_len, &sender_ip, &receiver_ip, 0);
-#ifdef SIMPLE_UDP_HETEROGENEOUS
-        heterogenous_udp_callback(c, &sender_ip, sport, &receiver_ip, dport, payload, payload_len);
-#endif
-#ifdef COAP_HETEROGENEOUS
-        PRINTF("Delivering packet to COAP from Wifi\n");
-        coap_receive_params(payload_len, &payload, sport, sender_ip);
-#endif
+        parse_incoming_packet(data, len, &sport, &dport, c, payload, &payload_len, &sender_ip, &receiver_ip, 0);
+        deliver_packet();
     } else if (data[1] == 'f') {        // Forward Packet part todo debug + add form flow
         clear_buff();
-        parse_incoming_packet(data, len, &sport, &dport, c, &payload, &payload_len, &sender_ip, &receiver_ip, 0);
-
-        uint8_t k_en, k_bw, k_etx;
-        fill_keys(&payload, payload_len, &k_en, &k_bw, &k_etx);
-
-        flow_struct *flow = find_flow(&receiver_ip, k_en, k_bw, k_etx);
-
-        if (!flow) {
-            PRINTF("F: Flow not found, creating new one\n");
-            flow = add_flow(&receiver_ip, RPL_TECHNOLOGY, k_en, k_bw, k_etx);
-        }
-
-        flow->validity = FLOW_VALIDITY;
-        PRINTF("Forwarding packet from WIFI using RPL: ");
-        PRINT6ADDR(&receiver_ip);
-        PRINTF("\n");
-
-        uip_udp_packet_forward(sender_ip, receiver_ip, sport, dport, &payload, payload_len);
-        leds_on(RPL_FORWARD_LED);
-        inc_sent_rpl();
+        parse_incoming_packet(data, len, &sport, &dport, c, payload, &payload_len, &sender_ip, &receiver_ip, 0);
+        forward_packet();
+    } else if (data[1] == 'm') {
+        serial_frame_flush();
+        if (data[2] == '2')
+            serial_mode = SERIAL_MODE_BATCH;
+        else if (data[2] == '1')
+            serial_mode = SERIAL_MODE_BINARY;
+        else
+            serial_mode = SERIAL_MODE_ASCII;
+        clear_flow_announcements();
+        printf("$m;%d;\n", serial_mode);
+        return 1;
     }
     return 0;
 }
@@ -277,7 +374,7 @@ int handle_commands(char *data, uint8_t len) {
  * Function handles requests to print data
  * m -> prints metrics table
  * f -> prints flow table
- * s -> prints statistics
+ * s -> prints statistics as binary frame (see statistics.h)
  *
  * @param data
  * @param len
@@ -295,7 +392,7 @@ int handle_prints(char *data, int len) {
     }
 #ifdef HETEROGENEOUS_STATISTICS
     else if (data[1] == 's') {
-        print_statistics_table();
+        statistics_print();
     }
 #endif
     printf(PRINT_END_SYMBOL);
@@ -326,53 +423,8 @@ int handle_requests(char *data, int len) {
         int question_id;
         clear_buff();
 
-        question_id = parse_incoming_packet(data, len, &sport, &dport, c, &payload, &payload_len, &sender_ip, &receiver_ip, -1);
-        uint8_t k_en, k_bw, k_etx;
-        fill_keys(&payload, payload_len, &k_en, &k_bw, &k_etx);
-        flow_struct *flow = find_flow(&receiver_ip, k_en, k_bw, k_etx);
-
-        PRINTF("W: forwarding callback called for packet from: ");
-        PRINT6ADDR(&sender_ip);
-        PRINTF(" to: ");
-        PRINT6ADDR(&receiver_ip);
-        PRINTF(" data: %s\n", payload);
-
-        if (!flow) {
-            PRINTF("W: Flow not found, creating new one\n");
-            uint8_t dst_technology = select_technology(k_en, k_bw, k_etx);
-            flow = add_flow(&receiver_ip, dst_technology, k_en, k_bw, k_etx);
-        }
-
-        if (flow) {
-            flow->validity = FLOW_VALIDITY;
-            PRINTF("W: flow flags: %d\n", flow->flags);
-            if (flow->technology == RPL_TECHNOLOGY) {
-                printf("$p;%d;0;\n", question_id);
-                forwarding_semafor = 1;
-                uip_udp_packet_forward(sender_ip, receiver_ip, sport, dport, &payload, payload_len);
-                leds_on(RPL_FORWARD_LED);
-
-            } else {
-                printf("$p;%d;1;\n", question_id);
-                leds_on(WIFI_FORWARD_LED);
-                flow->flags &= ~PND;
-                flow->flags |= CNF;
-            }
-        }
-
-        flow_struct *src_flow = find_flow(&sender_ip, k_en, k_bw, k_etx);         // source flow
-
-        if (!src_flow) {
-            PRINTF("W: Creating new src flow\n");
-            src_flow = add_flow(&sender_ip, WIFI_TECHNOLOGY, k_en, k_bw, k_etx);
-        }
-        else if (src_flow->technology != WIFI_TECHNOLOGY) {
-            PRINTF("W: Marking src flow as WIFI\n");
-            src_flow->technology = WIFI_TECHNOLOGY;
-        }
-        src_flow->flags &= ~PND;
-        src_flow->flags |= CNF;
-
+        question_id = parse_incoming_packet(data, len, &sport, &dport, c, payload, &payload_len, &sender_ip, &receiver_ip, -1);
+        answer_route_request(question_id);
     }
     return 0;
 }
@@ -398,15 +450,19 @@ int handle_responses(char *data, int len) {
             i++;
         }
 
-        flow_struct *flow = find_flow_by_id(num[1], NULL);
+        flow_struct *flow = find_flow_by_id(num[1]);
         if (flow) {
+            if (flow->flags & PND)
+                statistics_query_answered(flow);
             if (num[2] == 1) {
                 flow->flags |= CNF;         // sets confirmed flag to true
             }
             else {
                 flow->flags &= ~CNF;        // sets confirmed flag to false
             }
-            flow->flags &= ~PND;            // removes pending flag
+            flow->flags &= ~(PND | ASK);            // removes pending flag
+            pending_flush(flow);            // sends packets held while waiting for answer
+            serial_frame_flush();
         }
         return 1;
     }
@@ -440,6 +496,87 @@ int handle_input(char *data) {
     return 0;
 }
 
+/**
+ * Decodes packet frame into payload buffer, addresses and ports. Frames sent by linux always carry addresses.
+ *
+ * @param frame
+ * @param len
+ * @return flow_id field of frame or -1 if frame is malformed
+ */
+static int decode_packet_frame(uint8_t *frame, uint16_t len) {
+    uint8_t *p = frame + 1;
+
+    if (len < 1 + SERIAL_FRAME_PACKET_HDR_LEN + SERIAL_FRAME_ADDR_LEN || !(p[0] & SERIAL_FRAME_F_ADDR)) {
+        return -1;
+    }
+    len -= 1 + SERIAL_FRAME_PACKET_HDR_LEN + SERIAL_FRAME_ADDR_LEN;
+    if (len > UIP_UDP_PACKET_MAX_PAYLOAD) {
+        return -1;
+    }
+
+    clear_buff();
+    memcpy(&sender_ip, p + 2, sizeof(uip_ipaddr_t));
+    memcpy(&receiver_ip, p + 2 + sizeof(uip_ipaddr_t), sizeof(uip_ipaddr_t));
+    p += 2 + SERIAL_FRAME_ADDR_LEN;
+    sport = (p[0] << 8) | p[1];
+    dport = (p[2] << 8) | p[3];
+    memcpy(payload, p + 4, len);
+    payload_len = len;
+    return frame[2];
+}
+
+/**
+ * Handles binary frame received over serial line
+ * p -> deliver packet to mote
+ * f -> request to forward packet using rpl
+ * ? -> route question with packet
+ * t -> ASCII command wrapped into frame
+ * b -> batch of records, every record is handled as single frame
+ *
+ * @param frame
+ * @param len
+ * @return
+ */
+int handle_frame(uint8_t *frame, uint16_t len) {
+    int id;
+
+    PRINTF("Handling frame %c\n", frame[0]);
+    if (frame[0] == SERIAL_FRAME_BATCH) {
+        uint16_t i = 1;
+
+        while (i < len && frame[i] > 0 && i + 1 + frame[i] <= len) {
+            if (frame[i + 1] != SERIAL_FRAME_BATCH)
+                handle_frame(&frame[i + 1], frame[i]);
+            i += 1 + frame[i];
+        }
+        return 1;
+    }
+
+    if (frame[0] == SERIAL_FRAME_TEXT) {
+        char line[SERIAL_FRAME_MAX_LEN];
+
+        memcpy(line, frame + 1, len - 1);
+        line[len - 1] = '\0';
+        return handle_input(line);
+    }
+
+    id = decode_packet_frame(frame, len);
+    if (id < 0) {
+        PRINTF("Malformed frame\n");
+        statistics_dropped(NULL, WIFI_TECHNOLOGY);
+        return 0;
+    }
+
+    if (frame[0] == SERIAL_FRAME_PACKET) {
+        deliver_packet();
+    } else if (frame[0] == SERIAL_FRAME_FORWARD) {
+        forward_packet();
+    } else if (frame[0] == SERIAL_FRAME_QUERY) {
+        answer_route_request(id);
+    }
+    return 1;
+}
+
 /**
  * Process which waits for serial line input
  */
@@ -456,6 +593,15 @@ PROCESS_THREAD(serial_connection, ev, data)
         if(ev == serial_line_event_message) {
             handle_input((char *)data);
         }
+        else if(ev == PROCESS_EVENT_POLL) {
+            uint16_t frame_len;
+            uint8_t *frame;
+
+            while ((frame = serial_frame_get(&frame_len)) != NULL) {
+                handle_frame(frame, frame_len);
+                serial_frame_release();
+            }
+        }
     }
     PROCESS_END();
 }
\ No newline at end of file
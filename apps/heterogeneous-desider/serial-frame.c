@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+#define DEBUG 0
+#include "net/ip/uip-debug.h"
+
+#include "serial-frame.h"
+#include "serial-connection.h"
+
+#include "contiki.h"
+#include "sys/ctimer.h"
+#include "dev/serial-line.h"
+#include "lib/crc16.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if CONTIKI_TARGET_ZOUL || CONTIKI_TARGET_CC2538DK
+#include "dev/uart.h"
+#include "usb/usb-serial.h"
+#include "dbg.h"
+#if DBG_CONF_USB
+#define set_input(f)  usb_serial_set_input(f)
+#else
+#define set_input(f)  uart_set_input(SERIAL_LINE_CONF_UART, f)
+#endif
+#define flush()       dbg_flush()
+#elif CONTIKI_TARGET_NATIVE
+#include <unistd.h>
+#define set_input(f)  select_set_callback(STDIN_FILENO, &stdin_fd)
+#define flush()       fflush(stdout)
+#else
+#define set_input(f)
+#define flush()       fflush(stdout)
+#endif
+
+#define SLIP_END     0300
+#define SLIP_ESC     0333
+#define SLIP_ESC_END 0334
+#define SLIP_ESC_ESC 0335
+
+uint8_t serial_mode = SERIAL_MODE_ASCII;
+
+static uint8_t rx_buf[SERIAL_FRAME_MAX_LEN];
+static uint16_t rx_len;
+static uint8_t rx_in_frame, rx_esc, rx_overflow;
+/* bytes of current frame, crc of all but two newest of them */
+static uint16_t rx_count, rx_crc;
+static uint8_t rx_tail[2];
+static volatile uint8_t rx_ready;
+
+static unsigned short tx_crc;
+
+static uint8_t batch_buf[SERIAL_FRAME_BATCH_SIZE];
+static uint16_t batch_len;
+static struct ctimer batch_timer;
+
+/**
+ * Writes one byte of frame, escapes SLIP special characters and updates crc
+ *
+ * @param c
+ */
+static void write_byte(uint8_t c) {
+    tx_crc = crc16_add(c, tx_crc);
+    if (c == SLIP_END) {
+        putchar(SLIP_ESC);
+        c = SLIP_ESC_END;
+    } else if (c == SLIP_ESC) {
+        putchar(SLIP_ESC);
+        c = SLIP_ESC_ESC;
+    }
+    putchar(c);
+}
+
+/**
+ * Writes part of frame body
+ */
+void serial_frame_write(const uint8_t *data, uint16_t len) {
+    uint16_t i;
+
+    for (i = 0; i < len; i++) {
+        write_byte(data[i]);
+    }
+}
+
+/**
+ * Starts frame, body is written by serial_frame_write() and frame is finished by serial_frame_end()
+ */
+void serial_frame_begin(uint8_t type) {
+    putchar(SLIP_END);
+    tx_crc = 0;
+    write_byte(type);
+}
+
+void serial_frame_end(void) {
+    unsigned short crc = tx_crc;
+
+    write_byte(crc & 0xff);
+    write_byte(crc >> 8);
+    putchar(SLIP_END);
+    flush();
+}
+
+/**
+ * Writes packet record as one frame, see serial-frame.h for format
+ */
+void serial_frame_write_packet(uint8_t type, uint8_t flags, uint8_t flow_id, const uip_ipaddr_t *from,
+                               const uip_ipaddr_t *to, uint16_t port1, uint16_t port2, const uint8_t *data,
+                               uint16_t len) {
+    serial_frame_begin(type);
+    write_byte(flags);
+    write_byte(flow_id);
+    if (flags & SERIAL_FRAME_F_ADDR) {
+        serial_frame_write((uint8_t *) from, sizeof(uip_ipaddr_t));
+        serial_frame_write((uint8_t *) to, sizeof(uip_ipaddr_t));
+    }
+    write_byte(port1 >> 8);
+    write_byte(port1 & 0xff);
+    write_byte(port2 >> 8);
+    write_byte(port2 & 0xff);
+    serial_frame_write(data, len);
+    serial_frame_end();
+}
+
+/**
+ * Writes collected batch as one frame
+ */
+void serial_frame_flush(void) {
+    ctimer_stop(&batch_timer);
+    if (batch_len == 0) {
+        return;
+    }
+    PRINTF("Flushing batch of %d bytes\n", batch_len);
+    serial_frame_begin(SERIAL_FRAME_BATCH);
+    serial_frame_write(batch_buf, batch_len);
+    serial_frame_end();
+    batch_len = 0;
+}
+
+static void batch_expired(void *ptr) {
+    serial_frame_flush();
+}
+
+/**
+ * Adds packet record to batch. Record which can not fit into empty batch is written as single frame.
+ */
+void serial_frame_batch_packet(uint8_t type, uint8_t flags, uint8_t flow_id, const uip_ipaddr_t *from,
+                               const uip_ipaddr_t *to, uint16_t port1, uint16_t port2, const uint8_t *data,
+                               uint16_t len) {
+    uint16_t record_len = 1 + SERIAL_FRAME_PACKET_HDR_LEN + ((flags & SERIAL_FRAME_F_ADDR) ? SERIAL_FRAME_ADDR_LEN : 0)
+                          + len;
+    uint8_t *p;
+
+    if (record_len > 255 || record_len + 1 > SERIAL_FRAME_BATCH_SIZE) {
+        serial_frame_flush();
+        serial_frame_write_packet(type, flags, flow_id, from, to, port1, port2, data, len);
+        return;
+    }
+    if (batch_len + record_len + 1 > SERIAL_FRAME_BATCH_SIZE) {
+        serial_frame_flush();
+    }
+
+    p = &batch_buf[batch_len];
+    *p++ = record_len;
+    *p++ = type;
+    *p++ = flags;
+    *p++ = flow_id;
+    if (flags & SERIAL_FRAME_F_ADDR) {
+        memcpy(p, from, sizeof(uip_ipaddr_t));
+        memcpy(p + sizeof(uip_ipaddr_t), to, sizeof(uip_ipaddr_t));
+        p += SERIAL_FRAME_ADDR_LEN;
+    }
+    *p++ = port1 >> 8;
+    *p++ = port1 & 0xff;
+    *p++ = port2 >> 8;
+    *p++ = port2 & 0xff;
+    memcpy(p, data, len);
+
+    if (batch_len == 0) {
+        ctimer_set(&batch_timer, SERIAL_FRAME_BATCH_DELAY, batch_expired, NULL);
+    }
+    batch_len += record_len + 1;
+    if (batch_len == SERIAL_FRAME_BATCH_SIZE) {
+        serial_frame_flush();
+    }
+}
+
+/**
+ * Starts collecting frame, body is kept only if previous frame was processed
+ */
+static void rx_start(void) {
+    rx_esc = 0;
+    rx_count = 0;
+    rx_crc = 0;
+    rx_overflow = rx_ready;
+    if (!rx_ready)
+        rx_len = 0;
+}
+
+/**
+ * Input function called by uart driver for every received byte. Bytes between two SLIP END bytes are collected into
+ * frame, all others are passed to serial line. Frames received while previous frame is not processed are dropped.
+ *
+ * Frame mode is left only by END which closes frame with valid crc. END after too short or corrupted frame starts
+ * new frame instead, so that when one END byte is lost, next frame (back-to-back END bytes) brings receiver back in
+ * sync. Crc is computed while bytes arrive, two newest bytes are held back as they may be crc of the frame.
+ *
+ * @param c
+ * @return
+ */
+int serial_frame_input_byte(unsigned char c) {
+    if (c == SLIP_END) {
+        if (!rx_in_frame) {
+            rx_in_frame = 1;
+            rx_start();
+            return 0;
+        }
+        if (rx_count < 3 || rx_crc != (rx_tail[0] | (rx_tail[1] << 8))) {
+            rx_start();
+            return 0;
+        }
+        rx_in_frame = 0;
+        if (rx_overflow)
+            return 0;
+        rx_ready = 1;
+        process_poll(&serial_connection);
+        return 1;
+    }
+
+    if (!rx_in_frame) {
+        return serial_line_input_byte(c);
+    }
+
+    if (rx_esc) {
+        rx_esc = 0;
+        if (c == SLIP_ESC_END)
+            c = SLIP_END;
+        else if (c == SLIP_ESC_ESC)
+            c = SLIP_ESC;
+    } else if (c == SLIP_ESC) {
+        rx_esc = 1;
+        return 0;
+    }
+
+    if (rx_count >= 2)
+        rx_crc = crc16_add(rx_tail[0], rx_crc);
+    rx_tail[0] = rx_tail[1];
+    rx_tail[1] = c;
+    if (rx_count > SERIAL_FRAME_MAX_LEN) {
+        /* no frame is that long, bytes are serial line text received while out of sync */
+        rx_in_frame = 0;
+        return 0;
+    }
+    rx_count++;
+
+    if (rx_overflow || rx_len >= SERIAL_FRAME_MAX_LEN) {
+        rx_overflow = 1;
+        return 0;
+    }
+    rx_buf[rx_len++] = c;
+    return 0;
+}
+
+/**
+ * Returns received frame (type and body) or NULL if no frame is waiting
+ *
+ * @param len
+ * @return
+ */
+uint8_t *serial_frame_get(uint16_t *len) {
+    if (!rx_ready) {
+        return NULL;
+    }
+    *len = rx_len - 2;
+    return rx_buf;
+}
+
+/**
+ * Releases received frame, so next one can be received
+ */
+void serial_frame_release(void) {
+    rx_ready = 0;
+}
+
+#if CONTIKI_TARGET_NATIVE
+/**
+ * On native platform serial line is stdin, it is read by select loop of contiki-main
+ */
+static int stdin_set_fd(fd_set *rset, fd_set *wset) {
+    FD_SET(STDIN_FILENO, rset);
+    return 1;
+}
+
+static void stdin_handle_fd(fd_set *rset, fd_set *wset) {
+    unsigned char buf[64];
+    int i, len;
+
+    if (FD_ISSET(STDIN_FILENO, rset)) {
+        len = read(STDIN_FILENO, buf, sizeof(buf));
+        for (i = 0; i < len; i++) {
+            serial_frame_input_byte(buf[i]);
+        }
+    }
+}
+
+static const struct select_callback stdin_fd = { stdin_set_fd, stdin_handle_fd };
+#endif
+
+/**
+ * Replaces serial line input function
+ */
+void serial_frame_init(void) {
+    PRINTF("Initializing serial frames\n");
+    set_input(serial_frame_input_byte);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+
+#ifndef CONTIKI_SERIAL_FRAME_H
+#define CONTIKI_SERIAL_FRAME_H
+
+#include "contiki.h"
+#include "net/ip/uip.h"
+
+/**
+ * Binary framing of the serial link between mote and linux device. Every frame is SLIP encoded
+ * (END ... END) and has the form <type><body><crc16> where crc16 is computed over type and body by core/lib/crc16 and
+ * is sent low byte first. SLIP END never occurs in ASCII text, so frames and text lines may be interleaved on one line.
+ *
+ * Packet frames (types SERIAL_FRAME_PACKET, SERIAL_FRAME_FORWARD, SERIAL_FRAME_QUERY) share one body layout:
+ * <flags><flow_id>[<src:16><dst:16>]<port:2><port:2><payload>, ports are big endian and carry the same values as the
+ * ASCII commands. Addresses are present when SERIAL_FRAME_F_ADDR is set, otherwise linux takes them from the addresses
+ * cached for flow_id. Linux caches them only for records with SERIAL_FRAME_F_CACHE set.
+ *
+ * Batch frame (SERIAL_FRAME_BATCH) carries several records <len:1><type><body>, each record is content of single
+ * frame without crc. Mote collects packets into batch until it is full, SERIAL_FRAME_BATCH_DELAY passes or
+ * serial_frame_flush() is called. Linux may send batches too, records are handled in order.
+ *
+ * Linux enables binary output with "!m1", batched binary output with "!m2" and returns to ASCII with "!m0", mote
+ * confirms with "$m;<mode>;".
+ */
+
+#define SERIAL_FRAME_PACKET 'p'     // mote -> linux: send packet using wifi, linux -> mote: deliver packet
+#define SERIAL_FRAME_FORWARD 'f'    // linux -> mote: forward packet using rpl
+#define SERIAL_FRAME_QUERY '?'      // linux -> mote: packet with route question (flow_id carries question id)
+#define SERIAL_FRAME_TEXT 't'       // linux -> mote: ASCII command wrapped into frame
+#define SERIAL_FRAME_BATCH 'b'      // both directions: several records in one frame
+#define SERIAL_FRAME_STATISTICS 's' // mote -> linux: statistics dump, see statistics.h
+
+#define SERIAL_FRAME_F_ADDR 0x01
+#define SERIAL_FRAME_F_CACHE 0x02
+
+#define SERIAL_MODE_ASCII 0
+#define SERIAL_MODE_BINARY 1
+#define SERIAL_MODE_BATCH 2
+
+#ifdef SERIAL_FRAME_CONF_MAX_LEN
+#define SERIAL_FRAME_MAX_LEN SERIAL_FRAME_CONF_MAX_LEN
+#else
+#define SERIAL_FRAME_MAX_LEN 256
+#endif
+
+#ifdef SERIAL_FRAME_CONF_BATCH_SIZE
+#define SERIAL_FRAME_BATCH_SIZE SERIAL_FRAME_CONF_BATCH_SIZE
+#else
+#define SERIAL_FRAME_BATCH_SIZE 200
+#endif
+
+#ifdef SERIAL_FRAME_CONF_BATCH_DELAY
+#define SERIAL_FRAME_BATCH_DELAY SERIAL_FRAME_CONF_BATCH_DELAY
+#else
+#define SERIAL_FRAME_BATCH_DELAY (CLOCK_SECOND / 32)
+#endif
+
+#define SERIAL_FRAME_PACKET_HDR_LEN 6
+#define SERIAL_FRAME_ADDR_LEN 32
+
+extern uint8_t serial_mode;
+
+/**
+ * \brief       Replaces serial line input function, bytes outside of frames are passed to serial line
+ */
+void serial_frame_init(void);
+
+/**
+ * \brief       Input function called by uart driver for every received byte
+ * @param c
+ * @return
+ */
+int serial_frame_input_byte(unsigned char c);
+
+/**
+ * \brief       Returns received frame or NULL, frame must be released by serial_frame_release()
+ * @param len   length of frame without crc
+ * @return
+ */
+uint8_t *serial_frame_get(uint16_t *len);
+
+void serial_frame_release(void);
+
+/**
+ * \brief       Adds packet record to batch, batch is written when full, after SERIAL_FRAME_BATCH_DELAY or on flush
+ */
+void serial_frame_batch_packet(uint8_t type, uint8_t flags, uint8_t flow_id, const uip_ipaddr_t *from,
+                               const uip_ipaddr_t *to, uint16_t port1, uint16_t port2, const uint8_t *data,
+                               uint16_t len);
+
+/**
+ * \brief       Writes collected batch immediately
+ */
+void serial_frame_flush(void);
+
+/**
+ * \brief       Writes packet record as one frame
+ */
+void serial_frame_write_packet(uint8_t type, uint8_t flags, uint8_t flow_id, const uip_ipaddr_t *from,
+                               const uip_ipaddr_t *to, uint16_t port1, uint16_t port2, const uint8_t *data,
+                               uint16_t len);
+
+/**
+ * \brief       Starts frame of given type, frame is written incrementally and must be finished by serial_frame_end()
+ * @param type
+ */
+void serial_frame_begin(uint8_t type);
+
+void serial_frame_write(const uint8_t *data, uint16_t len);
+
+void serial_frame_end(void);
+
+#endif //CONTIKI_SERIAL_FRAME_H
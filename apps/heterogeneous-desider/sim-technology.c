@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+#define DEBUG 0
+#include "net/ip/uip-debug.h"
+
+#include "sim-technology.h"
+
+/**
+ * Send function of simulated driver, counts packets and bytes
+ *
+ * @param driver
+ * @param packet
+ * @return
+ */
+int sim_technology_send(const tech_driver *driver, const tech_packet *packet) {
+    sim_technology *sim = (sim_technology *) driver;
+
+    PRINTF("Simulated %s: %d bytes to ", driver->name, packet->len);
+    PRINT6ADDR(packet->to);
+    PRINTF("\n");
+
+    if (sim->fail)
+        return 0;
+    sim->packets++;
+    sim->bytes += packet->len;
+    return 1;
+}
+
+/**
+ * Resets counters of simulated driver
+ *
+ * @param sim
+ */
+void sim_technology_reset(sim_technology *sim) {
+    sim->packets = 0;
+    sim->bytes = 0;
+}
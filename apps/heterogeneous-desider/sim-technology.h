@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+
+#ifndef CONTIKI_SIM_TECHNOLOGY_H
+#define CONTIKI_SIM_TECHNOLOGY_H
+
+#include "heterogeneous-desider.h"
+
+/**
+ * Simulated technology driver, packets are only counted. Used for testing the desider with more technologies on
+ * native, e.g. second serial radio, BLE or LoRa stand-in:
+ *
+ *   SIM_TECHNOLOGY(lora, 3, 5, 2);
+ *   register_technology(&lora.driver);
+ *   add_metrics(3, en, bw, etx);
+ */
+typedef struct sim_technology {
+    tech_driver driver;
+    uint32_t packets;
+    uint32_t bytes;
+    uint8_t fail;       // nonzero -> send function reports failure
+} sim_technology;
+
+int sim_technology_send(const tech_driver *driver, const tech_packet *packet);
+
+#define SIM_TECHNOLOGY(name, type, capacity, energy) \
+    sim_technology name = { { #name, type, TECH_F_STATIC, capacity, energy, sim_technology_send, NULL }, 0, 0, 0 }
+
+void sim_technology_reset(sim_technology *sim);
+
+#endif //CONTIKI_SIM_TECHNOLOGY_H
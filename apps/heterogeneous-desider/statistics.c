@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+#define DEBUG 0
+#include "net/ip/uip-debug.h"
+
+#include "statistics.h"
+#include "flow-table.h"
+#include "serial-frame.h"
+
+#include "contiki.h"
+
+#ifdef HETEROGENEOUS_STATISTICS
+static tech_statistics techs[MAX_TECHNOLOGIES];
+
+/**
+ * Returns counters of technology, slot is assigned when technology is seen first time
+ *
+ * @param technology
+ * @return NULL if all slots are used by other technologies
+ */
+static tech_statistics *find_tech_statistics(uint8_t technology) {
+    uint8_t i;
+
+    for (i = 0; i < MAX_TECHNOLOGIES; i++) {
+        if (techs[i].technology == technology)
+            return &techs[i];
+        if (techs[i].technology == 0) {
+            techs[i].technology = technology;
+            return &techs[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Returns log2 bin of latency
+ *
+ * @param latency in clock ticks
+ * @return
+ */
+static uint8_t latency_bin(clock_time_t latency) {
+    uint8_t bin = 0;
+
+    while (latency && bin < STATISTICS_LATENCY_BINS - 1) {
+        latency >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+void statistics_sent(flow_struct *flow, uint8_t technology, uint16_t len, uint8_t forwarded, clock_time_t latency) {
+    tech_statistics *t = find_tech_statistics(technology);
+    uint8_t bin = latency_bin(latency);
+
+    if (t) {
+        t->packets++;
+        t->bytes += len;
+        if (forwarded)
+            t->forwarded++;
+        if (t->latency[bin] < 0xffff)
+            t->latency[bin]++;
+    }
+    if (flow) {
+        flow->stats.packets++;
+        flow->stats.bytes += len;
+        flow->stats.pending += latency;
+    }
+}
+
+void statistics_dropped(flow_struct *flow, uint8_t technology) {
+    tech_statistics *t = find_tech_statistics(technology);
+
+    if (t)
+        t->drops++;
+    if (flow && flow->stats.drops < 0xffff)
+        flow->stats.drops++;
+}
+
+const tech_statistics *statistics_technology(uint8_t technology) {
+    uint8_t i;
+
+    for (i = 0; i < MAX_TECHNOLOGIES; i++) {
+        if (techs[i].technology == technology)
+            return &techs[i];
+    }
+    return NULL;
+}
+
+void statistics_query_sent(flow_struct *flow) {
+    if (flow->stats.queries < 0xffff)
+        flow->stats.queries++;
+}
+
+void statistics_query_answered(flow_struct *flow) {
+    clock_time_t rtt = clock_time() - flow->asked;
+
+    flow->stats.rtt = rtt > 0xffff ? 0xffff : rtt;
+}
+
+void statistics_query_timeout(flow_struct *flow) {
+    if (flow->stats.timeouts < 0xffff)
+        flow->stats.timeouts++;
+}
+
+static void put_u8(statistics_writer write, void *ptr, uint8_t value) {
+    write(&value, 1, ptr);
+}
+
+static void put_u16(statistics_writer write, void *ptr, uint16_t value) {
+    uint8_t buf[2];
+
+    buf[0] = value >> 8;
+    buf[1] = value & 0xff;
+    write(buf, sizeof(buf), ptr);
+}
+
+static void put_u32(statistics_writer write, void *ptr, uint32_t value) {
+    uint8_t buf[4];
+
+    buf[0] = value >> 24;
+    buf[1] = (value >> 16) & 0xff;
+    buf[2] = (value >> 8) & 0xff;
+    buf[3] = value & 0xff;
+    write(buf, sizeof(buf), ptr);
+}
+
+/**
+ * Produces dump described in statistics.h
+ */
+uint16_t statistics_dump(statistics_writer write, void *ptr) {
+    flow_struct *flow;
+    uint8_t i, j, count = 0;
+
+    for (i = 0; i < MAX_TECHNOLOGIES; i++) {
+        if (techs[i].technology)
+            count++;
+    }
+
+    put_u8(write, ptr, STATISTICS_VERSION);
+    put_u16(write, ptr, CLOCK_SECOND);
+    put_u8(write, ptr, count);
+    put_u8(write, ptr, flow_table_count());
+
+    for (i = 0; i < count; i++) {
+        put_u8(write, ptr, techs[i].technology);
+        put_u32(write, ptr, techs[i].packets);
+        put_u32(write, ptr, techs[i].forwarded);
+        put_u32(write, ptr, techs[i].bytes);
+        put_u32(write, ptr, techs[i].drops);
+        for (j = 0; j < STATISTICS_LATENCY_BINS; j++) {
+            put_u16(write, ptr, techs[i].latency[j]);
+        }
+    }
+
+    for (flow = flow_table_head(); flow != NULL; flow = flow->next) {
+        put_u8(write, ptr, flow->flow_id);
+        put_u8(write, ptr, flow->technology);
+        put_u8(write, ptr, flow->flags);
+        write((const uint8_t *) &flow->to, sizeof(uip_ipaddr_t), ptr);
+        put_u32(write, ptr, flow->stats.packets);
+        put_u32(write, ptr, flow->stats.bytes);
+        put_u32(write, ptr, flow->stats.pending);
+        put_u16(write, ptr, flow->stats.drops);
+        put_u16(write, ptr, flow->stats.queries);
+        put_u16(write, ptr, flow->stats.timeouts);
+        put_u16(write, ptr, flow->stats.rtt);
+    }
+
+    return 5 + count * (17 + 2 * STATISTICS_LATENCY_BINS) + flow_table_count() * (3 + sizeof(uip_ipaddr_t) + 20);
+}
+
+static void write_frame(const uint8_t *data, uint16_t len, void *ptr) {
+    serial_frame_write(data, len);
+}
+
+void statistics_print(void) {
+    PRINTF("Printing statistics\n");
+    serial_frame_begin(SERIAL_FRAME_STATISTICS);
+    statistics_dump(write_frame, NULL);
+    serial_frame_end();
+}
+#endif /* HETEROGENEOUS_STATISTICS */
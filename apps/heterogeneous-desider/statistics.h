@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+
+#ifndef CONTIKI_HETEROGENEOUS_STATISTICS_H
+#define CONTIKI_HETEROGENEOUS_STATISTICS_H
+
+#include "heterogeneous-desider.h"
+
+/**
+ * Statistics are collected when HETEROGENEOUS_STATISTICS is defined. Counters of technologies are kept for the whole
+ * run, counters of flows are part of flow_struct and disappear with the flow.
+ *
+ * Dump is binary, multi-byte values are big endian:
+ * <version:1><clock_second:2><techs:1><flows:1>
+ * techs times  <technology:1><packets:4><forwarded:4><bytes:4><drops:4><latency:2*STATISTICS_LATENCY_BINS>
+ * flows times  <flow_id:1><technology:1><flags:1><dst:16><packets:4><bytes:4><pending:4><drops:2><queries:2>
+ *              <timeouts:2><rtt:2>
+ * Number of latency bins is derived from length of dump. Linux device receives dump as SERIAL_FRAME_STATISTICS frame
+ * on "#s" print request, CoAP clients read it from res_statistics resource.
+ */
+#define STATISTICS_VERSION 1
+
+#ifdef HETEROGENEOUS_STATISTICS
+/**
+ * \brief       Called for every chunk of dump
+ */
+typedef void (*statistics_writer)(const uint8_t *data, uint16_t len, void *ptr);
+
+/**
+ * \brief       Accounts packet sent or forwarded using technology
+ * @param flow      flow of packet, may be NULL
+ * @param technology
+ * @param len
+ * @param forwarded nonzero for packets of other nodes
+ * @param latency   clock ticks packet waited before it was sent
+ */
+void statistics_sent(flow_struct *flow, uint8_t technology, uint16_t len, uint8_t forwarded, clock_time_t latency);
+
+/**
+ * \brief       Accounts packet which could not be sent or received using technology
+ * @param flow      flow of packet, may be NULL
+ * @param technology
+ */
+void statistics_dropped(flow_struct *flow, uint8_t technology);
+
+/**
+ * \brief       Returns counters of technology
+ * @param technology
+ * @return      NULL if technology has not sent or dropped anything yet
+ */
+const tech_statistics *statistics_technology(uint8_t technology);
+
+void statistics_query_sent(flow_struct *flow);
+void statistics_query_answered(flow_struct *flow);
+void statistics_query_timeout(flow_struct *flow);
+
+/**
+ * \brief       Produces binary dump of all counters
+ * @param write
+ * @param ptr   passed to writer
+ * @return      length of dump
+ */
+uint16_t statistics_dump(statistics_writer write, void *ptr);
+
+/**
+ * \brief       Writes dump to serial line as one frame
+ */
+void statistics_print(void);
+#else
+#define statistics_sent(flow, technology, len, forwarded, latency)
+#define statistics_dropped(flow, technology)
+#define statistics_technology(technology) NULL
+#define statistics_query_sent(flow)
+#define statistics_query_answered(flow)
+#define statistics_query_timeout(flow)
+#endif /* HETEROGENEOUS_STATISTICS */
+
+#endif //CONTIKI_HETEROGENEOUS_STATISTICS_H
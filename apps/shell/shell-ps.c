@@ -43,31 +43,106 @@
 #include <stdio.h>
 #include <string.h>
 
+#if PROCESS_ACCOUNTING
+/*
+ * Record of psdump, one per process followed by the process name, in
+ * host byte order. len is the number of bytes after the len field.
+ * Times are in rtimer ticks, rtimer_second tells how many make a
+ * second.
+ */
+struct ps_msg {
+  uint16_t len;
+  uint16_t reserved;
+  uint32_t rtimer_second;
+  uint32_t calls;
+  uint32_t events;
+  uint32_t time;
+  uint32_t max;
+};
+#endif /* PROCESS_ACCOUNTING */
+
 /*---------------------------------------------------------------------------*/
 PROCESS(shell_ps_process, "ps");
 SHELL_COMMAND(ps_command,
 	      "ps",
-	      "ps: list all running processes",
+	      "ps [-r]: list all running processes",
 	      &shell_ps_process);
+#if PROCESS_ACCOUNTING
+PROCESS(shell_psdump_process, "psdump");
+SHELL_COMMAND(psdump_command,
+	      "psdump",
+	      "psdump: binary dump of process accounting",
+	      &shell_psdump_process);
+#endif /* PROCESS_ACCOUNTING */
 /*---------------------------------------------------------------------------*/
 PROCESS_THREAD(shell_ps_process, ev, data)
 {
   struct process *p;
   PROCESS_BEGIN();
 
+#if PROCESS_ACCOUNTING
+  shell_output_str(&ps_command, "Processes (calls events time max, rtimer ticks):", "");
+#else
   shell_output_str(&ps_command, "Processes:", "");
+#endif /* PROCESS_ACCOUNTING */
   for(p = PROCESS_LIST(); p != NULL; p = p->next) {
     char namebuf[30];
+#if PROCESS_ACCOUNTING
+    char buf[48];
+
+    strncpy(namebuf, PROCESS_NAME_STRING(p), sizeof(namebuf) - 1);
+    namebuf[sizeof(namebuf) - 1] = 0;
+    snprintf(buf, sizeof(buf), " %lu %lu %lu %lu",
+             (unsigned long)p->accounting.calls,
+             (unsigned long)p->accounting.events,
+             (unsigned long)p->accounting.time,
+             (unsigned long)p->accounting.max);
+    shell_output_str(&ps_command, namebuf, buf);
+#else
     strncpy(namebuf, PROCESS_NAME_STRING(p), sizeof(namebuf));
     shell_output_str(&ps_command, namebuf, "");
+#endif /* PROCESS_ACCOUNTING */
+  }
+
+#if PROCESS_ACCOUNTING
+  if(data != NULL && strcmp(data, "-r") == 0) {
+    process_accounting_reset();
+  }
+#endif /* PROCESS_ACCOUNTING */
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+#if PROCESS_ACCOUNTING
+PROCESS_THREAD(shell_psdump_process, ev, data)
+{
+  struct process *p;
+  struct ps_msg msg;
+  const char *name;
+  PROCESS_BEGIN();
+
+  for(p = PROCESS_LIST(); p != NULL; p = p->next) {
+    name = PROCESS_NAME_STRING(p);
+    msg.len = sizeof(msg) - sizeof(msg.len) + strlen(name);
+    msg.reserved = 0;
+    msg.rtimer_second = RTIMER_SECOND;
+    msg.calls = p->accounting.calls;
+    msg.events = p->accounting.events;
+    msg.time = p->accounting.time;
+    msg.max = p->accounting.max;
+    shell_output(&psdump_command, &msg, sizeof(msg), name, strlen(name));
   }
 
   PROCESS_END();
 }
+#endif /* PROCESS_ACCOUNTING */
 /*---------------------------------------------------------------------------*/
 void
 shell_ps_init(void)
 {
   shell_register_command(&ps_command);
+#if PROCESS_ACCOUNTING
+  shell_register_command(&psdump_command);
+#endif /* PROCESS_ACCOUNTING */
 }
 /*---------------------------------------------------------------------------*/
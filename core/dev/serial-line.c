@@ -95,33 +95,41 @@ PROCESS_THREAD(serial_line_process, ev, data)
   ptr = 0;
 
   while(1) {
-    /* Fill application buffer until newline or empty */
-    int c = ringbuf_get(&rxbuf);
-    
-    if(c == -1) {
+    /* Fill application buffer from the contiguous input until newline */
+    const uint8_t *span, *end;
+    int n = ringbuf_peek_get(&rxbuf, &span);
+    int len, copy;
+
+    if(n == 0) {
       /* Buffer empty, wait for poll */
       PROCESS_YIELD();
+      continue;
+    }
+
+    end = memchr(span, END, n);
+    len = end != NULL ? end - span : n;
+    /* Ignore characters that do not fit (wait for EOL) */
+    copy = MIN(len, BUFSIZE - 1 - ptr);
+    memcpy(&buf[ptr], span, copy);
+    ptr += copy;
+
+    if(end == NULL) {
+      ringbuf_commit_get(&rxbuf, n);
     } else {
-      if(c != END) {
-        if(ptr < BUFSIZE-1) {
-          buf[ptr++] = (uint8_t)c;
-        } else {
-          /* Ignore character (wait for EOL) */
-        }
-      } else {
-        /* Terminate */
-        buf[ptr++] = (uint8_t)'\0';
-
-        /* Broadcast event */
-        process_post(PROCESS_BROADCAST, serial_line_event_message, buf);
-
-        /* Wait until all processes have handled the serial line event */
-        if(PROCESS_ERR_OK ==
-          process_post(PROCESS_CURRENT(), PROCESS_EVENT_CONTINUE, NULL)) {
-          PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE);
-        }
-        ptr = 0;
+      ringbuf_commit_get(&rxbuf, len + 1);
+
+      /* Terminate */
+      buf[ptr++] = (uint8_t)'\0';
+
+      /* Broadcast event */
+      process_post(PROCESS_BROADCAST, serial_line_event_message, buf);
+
+      /* Wait until all processes have handled the serial line event */
+      if(PROCESS_ERR_OK ==
+        process_post(PROCESS_CURRENT(), PROCESS_EVENT_CONTINUE, NULL)) {
+        PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE);
       }
+      ptr = 0;
     }
   }
 
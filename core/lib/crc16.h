@@ -49,12 +49,26 @@
  * calculation module is an iterative CRC calculator that can be used
  * to cumulatively update a CRC checksum for every incoming byte.
  *
+ * CRC16_CONF_METHOD selects how the checksum is computed, trading
+ * code size for speed:
+ *  - CRC_METHOD_BITWISE (default) uses shifts only and no table
+ *  - CRC_METHOD_TABLE uses one 512 byte lookup table
+ *  - CRC_METHOD_SLICE4 and CRC_METHOD_SLICE8 use 4 or 8 tables
+ *    (2 or 4 kbytes) and let crc16_data() fold 4 or 8 bytes per step
+ *
+ * All methods produce the same checksum.
+ *
  * @{
  */
 
 #ifndef CRC16_H_
 #define CRC16_H_
 
+#define CRC_METHOD_BITWISE 0
+#define CRC_METHOD_TABLE   1
+#define CRC_METHOD_SLICE4  4
+#define CRC_METHOD_SLICE8  8
+
 /**
  * \brief      Update an accumulated CRC16 checksum with one byte.
  * \param b    The byte to be added to the checksum
@@ -65,9 +79,9 @@
  *             with one byte. It can be used as a running checksum, or
  *             to checksum an entire data block.
  *
- *             \note The algorithm used in this implementation is
+ *             \note With CRC_METHOD_BITWISE the algorithm is
  *             tailored for a running checksum and does not perform as
- *             well as a table-driven algorithm when checksumming an
+ *             well as the table-driven methods when checksumming an
  *             entire data block.
  *
  */
@@ -82,9 +96,9 @@ unsigned short crc16_add(unsigned char b, unsigned short crc);
  *
  *             This function calculates the CRC16 checksum of a data area.
  *
- *             \note The algorithm used in this implementation is
+ *             \note With CRC_METHOD_BITWISE the algorithm is
  *             tailored for a running checksum and does not perform as
- *             well as a table-driven algorithm when checksumming an
+ *             well as the table-driven methods when checksumming an
  *             entire data block.
  */
 unsigned short crc16_data(const unsigned char *data, int datalen,
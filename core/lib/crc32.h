@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ * Author: Tomas Hermanek
+ */
+
+/**
+ * \file
+ *         Header file for the CRC-32 and CRC-32C calculation
+ * \author
+ *         Tomas Hermanek
+ *
+ */
+
+/** \addtogroup lib
+ * @{ */
+
+/**
+ * \defgroup crc32 Cyclic Redundancy Check 32 (CRC-32, CRC-32C) calculation
+ *
+ * CRC-32 (IEEE 802.3, as used by zlib and PNG) and CRC-32C (Castagnoli,
+ * as used by iSCSI and ext4) with the streaming interface of the \ref
+ * crc16 "CRC16 module": a checksum is started with 0 and the returned
+ * value is passed back in to extend it with more data. The pre- and
+ * post-inversion of the standard algorithms is done inside, so the
+ * value returned at any point is the finished checksum of all data
+ * seen so far.
+ *
+ * CRC32_CONF_METHOD selects the implementation as CRC16_CONF_METHOD
+ * does for CRC16. The tables take 1 kbyte per table and checksum,
+ * i.e. up to 16 kbytes with CRC_METHOD_SLICE8.
+ *
+ * @{
+ */
+
+#ifndef CRC32_H_
+#define CRC32_H_
+
+#include <stdint.h>
+
+/* CRC_METHOD_* constants */
+#include "lib/crc16.h"
+
+/**
+ * \brief      Update a CRC-32 checksum with one byte.
+ * \param b    The byte to be added to the checksum
+ * \param crc  The checksum of the preceding data, or zero.
+ * \return     The updated CRC-32 checksum.
+ */
+uint32_t crc32_add(unsigned char b, uint32_t crc);
+
+/**
+ * \brief      Calculate the CRC-32 over a data area
+ * \param data Pointer to the data
+ * \param datalen The length of the data
+ * \param crc  The checksum of the preceding data, or zero.
+ * \return     The CRC-32 checksum.
+ */
+uint32_t crc32_data(const unsigned char *data, int datalen, uint32_t crc);
+
+/**
+ * \brief      Update a CRC-32C checksum with one byte.
+ * \param b    The byte to be added to the checksum
+ * \param crc  The checksum of the preceding data, or zero.
+ * \return     The updated CRC-32C checksum.
+ */
+uint32_t crc32c_add(unsigned char b, uint32_t crc);
+
+/**
+ * \brief      Calculate the CRC-32C over a data area
+ * \param data Pointer to the data
+ * \param datalen The length of the data
+ * \param crc  The checksum of the preceding data, or zero.
+ * \return     The CRC-32C checksum.
+ */
+uint32_t crc32c_data(const unsigned char *data, int datalen, uint32_t crc);
+
+#endif /* CRC32_H_ */
+
+/** @} */
+/** @} */
@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ * Author: Tomas Hermanek
+ */
+
+/**
+ * \addtogroup heapmem
+ * @{
+ */
+
+/**
+ * \file
+ *         Implementation of the bounded-time heap allocator
+ * \author
+ *         Tomas Hermanek
+ */
+
+#include "lib/heapmem.h"
+#include <stdint.h>
+#include <string.h>
+
+#ifdef HEAPMEM_CONF_ARENA_SIZE
+#define HEAPMEM_ARENA_SIZE HEAPMEM_CONF_ARENA_SIZE
+#else
+#define HEAPMEM_ARENA_SIZE 4096
+#endif
+
+/* Number of power of two size classes */
+#ifdef HEAPMEM_CONF_FL_COUNT
+#define FL_COUNT HEAPMEM_CONF_FL_COUNT
+#else
+#define FL_COUNT 12
+#endif
+
+/* Number of linear subdivisions of a power of two class, log2 */
+#ifdef HEAPMEM_CONF_SL_LOG2
+#define SL_LOG2 HEAPMEM_CONF_SL_LOG2
+#else
+#define SL_LOG2 3
+#endif
+
+#if FL_COUNT > 31 || SL_LOG2 > 3
+#error "heapmem: FL_COUNT must be below 32 and SL_LOG2 at most 3"
+#endif
+
+#define SL_COUNT    (1 << SL_LOG2)
+#define ALIGN_LOG2  (sizeof(void *) > 4 ? 3 : 2)
+#define ALIGN       ((size_t)1 << ALIGN_LOG2)
+#define FL_SHIFT    (SL_LOG2 + ALIGN_LOG2)
+#define SMALL_BLOCK ((size_t)1 << FL_SHIFT)
+
+#define FREE_BIT    ((size_t)1)
+
+/*
+ * Blocks follow each other in the arena. Free blocks keep their list
+ * links in the first bytes of the payload.
+ */
+struct block {
+  struct block *prev_phys;
+  size_t size;                  /* payload bytes, FREE_BIT when free */
+  struct block *next_free;
+  struct block *prev_free;
+};
+
+#define HEADER      offsetof(struct block, next_free)
+#define MIN_SIZE    (sizeof(struct block) - HEADER)
+
+static union {
+  uint32_t align32;
+  void *align_ptr;
+  uint8_t bytes[HEAPMEM_ARENA_SIZE];
+} arena;
+
+static uint32_t fl_bitmap;
+static uint8_t sl_bitmap[FL_COUNT];
+static struct block *blocks[FL_COUNT][SL_COUNT];
+
+static uint8_t inited;
+static size_t heap_size, used, max_used, free_bytes;
+static unsigned short free_blocks, used_blocks, failures;
+
+/*---------------------------------------------------------------------------*/
+/* Index of the highest set bit, x must not be 0 */
+static uint8_t
+fls(uint32_t x)
+{
+#ifdef __GNUC__
+  return 8 * sizeof(unsigned long) - 1 - __builtin_clzl(x);
+#else
+  uint8_t i = 0;
+
+  while(x >>= 1) {
+    i++;
+  }
+  return i;
+#endif /* __GNUC__ */
+}
+/*---------------------------------------------------------------------------*/
+/* Index of the lowest set bit, x must not be 0 */
+static uint8_t
+ffs32(uint32_t x)
+{
+#ifdef __GNUC__
+  return __builtin_ctzl(x);
+#else
+  uint8_t i = 0;
+
+  while(!(x & 1)) {
+    x >>= 1;
+    i++;
+  }
+  return i;
+#endif /* __GNUC__ */
+}
+/*---------------------------------------------------------------------------*/
+static size_t
+block_size(const struct block *b)
+{
+  return b->size & ~FREE_BIT;
+}
+/*---------------------------------------------------------------------------*/
+static struct block *
+next_phys(const struct block *b)
+{
+  return (struct block *)((uint8_t *)b + HEADER + block_size(b));
+}
+/*---------------------------------------------------------------------------*/
+static void
+mapping(size_t size, uint8_t *fl, uint8_t *sl)
+{
+  uint8_t f;
+
+  if(size < SMALL_BLOCK) {
+    *fl = 0;
+    *sl = size >> ALIGN_LOG2;
+  } else {
+    f = fls(size);
+    *sl = (size >> (f - SL_LOG2)) ^ SL_COUNT;
+    *fl = f - FL_SHIFT + 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Blocks above the last class all go to the last list */
+static void
+mapping_insert(size_t size, uint8_t *fl, uint8_t *sl)
+{
+  mapping(size, fl, sl);
+  if(*fl >= FL_COUNT) {
+    *fl = FL_COUNT - 1;
+    *sl = SL_COUNT - 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+insert_free(struct block *b)
+{
+  uint8_t fl, sl;
+
+  mapping_insert(block_size(b), &fl, &sl);
+  b->size |= FREE_BIT;
+  b->prev_free = NULL;
+  b->next_free = blocks[fl][sl];
+  if(b->next_free != NULL) {
+    b->next_free->prev_free = b;
+  }
+  blocks[fl][sl] = b;
+  fl_bitmap |= (uint32_t)1 << fl;
+  sl_bitmap[fl] |= 1 << sl;
+  free_bytes += block_size(b);
+  free_blocks++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_free(struct block *b)
+{
+  uint8_t fl, sl;
+
+  mapping_insert(block_size(b), &fl, &sl);
+  if(b->prev_free != NULL) {
+    b->prev_free->next_free = b->next_free;
+  } else {
+    blocks[fl][sl] = b->next_free;
+    if(b->next_free == NULL) {
+      sl_bitmap[fl] &= ~(1 << sl);
+      if(sl_bitmap[fl] == 0) {
+        fl_bitmap &= ~((uint32_t)1 << fl);
+      }
+    }
+  }
+  if(b->next_free != NULL) {
+    b->next_free->prev_free = b->prev_free;
+  }
+  b->size &= ~FREE_BIT;
+  free_bytes -= block_size(b);
+  free_blocks--;
+}
+/*---------------------------------------------------------------------------*/
+/* First block from a list whose every block is at least size bytes */
+static struct block *
+find_suitable(size_t size)
+{
+  uint8_t fl, sl;
+  uint32_t map;
+
+  if(size >= SMALL_BLOCK) {
+    size += ((size_t)1 << (fls(size) - SL_LOG2)) - 1;
+  }
+  mapping(size, &fl, &sl);
+  if(fl >= FL_COUNT) {
+    return NULL;
+  }
+
+  map = sl_bitmap[fl] & (~0U << sl);
+  if(map == 0) {
+    map = fl_bitmap & (~(uint32_t)0 << (fl + 1));
+    if(map == 0) {
+      return NULL;
+    }
+    fl = ffs32(map);
+    map = sl_bitmap[fl];
+  }
+  sl = ffs32(map);
+  return blocks[fl][sl];
+}
+/*---------------------------------------------------------------------------*/
+void
+heapmem_init(void)
+{
+  struct block *first, *last;
+
+  memset(blocks, 0, sizeof(blocks));
+  memset(sl_bitmap, 0, sizeof(sl_bitmap));
+  fl_bitmap = 0;
+  used = max_used = free_bytes = 0;
+  free_blocks = used_blocks = failures = 0;
+
+  /* One free block spanning the arena, followed by an empty used
+     block that stops merging at the end of the arena. The empty
+     block is accessed as a whole struct block, so room for all of
+     it is kept. */
+  first = (struct block *)arena.bytes;
+  first->prev_phys = NULL;
+  first->size = (HEAPMEM_ARENA_SIZE - HEADER - sizeof(struct block)) &
+    ~(ALIGN - 1);
+  last = next_phys(first);
+  last->prev_phys = first;
+  last->size = 0;
+  heap_size = first->size;
+  insert_free(first);
+
+  inited = 1;
+}
+/*---------------------------------------------------------------------------*/
+void *
+heapmem_alloc(size_t size)
+{
+  struct block *b, *rest;
+
+  if(!inited) {
+    heapmem_init();
+  }
+  if(size == 0) {
+    return NULL;
+  }
+
+  size = (size + ALIGN - 1) & ~(ALIGN - 1);
+  if(size < MIN_SIZE) {
+    size = MIN_SIZE;
+  }
+
+  b = find_suitable(size);
+  if(b == NULL) {
+    if(failures < 0xffff) {
+      failures++;
+    }
+    return NULL;
+  }
+  remove_free(b);
+
+  /* Return the tail of the block to the heap if it can hold a block */
+  if(block_size(b) >= size + HEADER + MIN_SIZE) {
+    rest = (struct block *)((uint8_t *)b + HEADER + size);
+    rest->prev_phys = b;
+    rest->size = block_size(b) - size - HEADER;
+    next_phys(rest)->prev_phys = rest;
+    b->size = size;
+    insert_free(rest);
+  }
+
+  used += block_size(b);
+  if(used > max_used) {
+    max_used = used;
+  }
+  used_blocks++;
+
+  return (uint8_t *)b + HEADER;
+}
+/*---------------------------------------------------------------------------*/
+void
+heapmem_free(void *ptr)
+{
+  struct block *b, *n;
+
+  if(ptr == NULL) {
+    return;
+  }
+
+  b = (struct block *)((uint8_t *)ptr - HEADER);
+  used -= block_size(b);
+  used_blocks--;
+
+  /* Merge with free neighbours, two free blocks are never adjacent */
+  if(b->prev_phys != NULL && (b->prev_phys->size & FREE_BIT)) {
+    remove_free(b->prev_phys);
+    b->prev_phys->size += HEADER + block_size(b);
+    b = b->prev_phys;
+  }
+  n = next_phys(b);
+  if(n->size & FREE_BIT) {
+    remove_free(n);
+    b->size += HEADER + block_size(n);
+  }
+  next_phys(b)->prev_phys = b;
+
+  insert_free(b);
+}
+/*---------------------------------------------------------------------------*/
+void
+heapmem_stats(struct heapmem_stats *stats)
+{
+  struct block *b;
+  uint8_t fl, sl;
+
+  if(!inited) {
+    heapmem_init();
+  }
+
+  stats->size = heap_size;
+  stats->used = used;
+  stats->max_used = max_used;
+  stats->free = free_bytes;
+  stats->free_blocks = free_blocks;
+  stats->used_blocks = used_blocks;
+  stats->failures = failures;
+
+  /* The largest free block is on the highest non-empty list */
+  stats->largest_free = 0;
+  if(fl_bitmap != 0) {
+    fl = fls(fl_bitmap);
+    sl = fls(sl_bitmap[fl]);
+    for(b = blocks[fl][sl]; b != NULL; b = b->next_free) {
+      if(block_size(b) > stats->largest_free) {
+        stats->largest_free = block_size(b);
+      }
+    }
+  }
+  stats->fragmentation = free_bytes == 0 ? 0 :
+    100 - (uint8_t)(stats->largest_free * 100 / free_bytes);
+}
+/*---------------------------------------------------------------------------*/
+
+/** @} */
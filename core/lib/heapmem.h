@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ * Author: Tomas Hermanek
+ */
+
+/**
+ * \addtogroup mem
+ * @{
+ */
+
+/**
+ * \defgroup heapmem Bounded-time heap allocator
+ *
+ * The heap allocator hands out variable size blocks from a static
+ * arena of HEAPMEM_CONF_ARENA_SIZE bytes. It is a two-level
+ * segregated fit (TLSF) allocator: free blocks are kept on lists
+ * indexed by the power of two and the linear subdivision of their
+ * size, and two levels of bitmaps tell which lists are non-empty.
+ * heapmem_alloc() and heapmem_free() therefore take a bounded time
+ * that does not depend on the number of allocated blocks, and freed
+ * blocks are merged with their free neighbours immediately.
+ *
+ * Unlike \ref mmem "managed memory", blocks never move, so plain
+ * pointers are handed out. With MMEM_CONF_HEAPMEM the mmem API is
+ * served from this heap instead of being compacted on every free.
+ *
+ * Each block carries a header of two pointers. Lists cover sizes up
+ * to 2^(HEAPMEM_CONF_FL_COUNT - 1) times the smallest class (32
+ * bytes with 4 byte alignment, 64 with 8 byte alignment); larger
+ * requests fail.
+ * @{
+ */
+
+/**
+ * \file
+ *         Header file for the bounded-time heap allocator
+ * \author
+ *         Tomas Hermanek
+ */
+
+#ifndef HEAPMEM_H_
+#define HEAPMEM_H_
+
+#include "contiki-conf.h"
+#include <stddef.h>
+
+/**
+ * Counters of the heap, see heapmem_stats()
+ */
+struct heapmem_stats {
+  /* Bytes available for blocks after the arena bookkeeping */
+  size_t size;
+  /* Bytes in allocated blocks and the highest value seen */
+  size_t used, max_used;
+  /* Bytes in free blocks and size of the largest one */
+  size_t free, largest_free;
+  /* Number of free blocks and allocated blocks */
+  unsigned short free_blocks, used_blocks;
+  /* Allocations that could not be satisfied */
+  unsigned short failures;
+  /* Share of free memory not usable for the largest possible
+     allocation, in percent */
+  unsigned char fragmentation;
+};
+
+/**
+ * \brief      Allocate a block
+ * \param size Number of bytes
+ * \return     Pointer to the block aligned for any pointer or 32-bit
+ *             type, NULL if there is no free block large enough.
+ */
+void *heapmem_alloc(size_t size);
+
+/**
+ * \brief      Free a block
+ * \param ptr  A pointer returned by heapmem_alloc(), or NULL.
+ */
+void heapmem_free(void *ptr);
+
+/**
+ * \brief      Get counters of the heap
+ * \param stats Filled with the counters
+ *
+ *             Finding the largest free block walks one free list, the
+ *             other counters are kept up to date on every operation.
+ */
+void heapmem_stats(struct heapmem_stats *stats);
+
+/**
+ * \brief      Initialize the heap, all blocks are released
+ *
+ *             Called automatically on the first allocation.
+ */
+void heapmem_init(void);
+
+#endif /* HEAPMEM_H_ */
+
+/** @} */
+/** @} */
@@ -53,6 +53,34 @@ memb_init(struct memb *m)
 {
   memset(m->count, 0, m->num);
   memset(m->mem, 0, m->size * m->num);
+#if MEMB_WITH_FREELIST
+  if(m->freelist != NULL) {
+    m->freelist->free = 0;
+    m->freelist->top = 0;
+  }
+#endif /* MEMB_WITH_FREELIST */
+#if MEMB_STATS
+  m->used = 0;
+  m->max_used = 0;
+  m->failures = 0;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+/* Index of the block to which ptr points or -1 if ptr does not point
+   to the start of a block. */
+static int
+block_index(struct memb *m, void *ptr)
+{
+  unsigned long offset;
+
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+  offset = (char *)ptr - (char *)m->mem;
+  if(offset % m->size != 0) {
+    return -1;
+  }
+  return offset / m->size;
 }
 /*---------------------------------------------------------------------------*/
 void *
@@ -60,44 +88,77 @@ memb_alloc(struct memb *m)
 {
   int i;
 
-  for(i = 0; i < m->num; ++i) {
-    if(m->count[i] == 0) {
-      /* If this block was unused, we increase the reference count to
-	 indicate that it now is used and return a pointer to the
-	 memory block. */
-      ++(m->count[i]);
-      return (void *)((char *)m->mem + (i * m->size));
+#if MEMB_WITH_FREELIST
+  struct memb_freelist *fl = m->freelist;
+
+  if(fl != NULL) {
+    /* Free-list pool: reuse the most recently freed block, or take
+       the first block that was never allocated. */
+    if(fl->free != 0) {
+      i = fl->free - 1;
+      fl->free = fl->next[i];
+    } else if(fl->top < m->num) {
+      i = fl->top++;
+    } else {
+      i = m->num;
+    }
+  } else
+#endif /* MEMB_WITH_FREELIST */
+  {
+    for(i = 0; i < m->num; ++i) {
+      if(m->count[i] == 0) {
+        break;
+      }
+    }
+  }
+
+  if(i == m->num) {
+    /* No free block was found, so we return NULL to indicate failure
+       to allocate block. */
+#if MEMB_STATS
+    if(m->failures < 0xffff) {
+      m->failures++;
     }
+#endif
+    return NULL;
   }
 
-  /* No free block was found, so we return NULL to indicate failure to
-     allocate block. */
-  return NULL;
+  /* The block was unused, we increase the reference count to indicate
+     that it now is used and return a pointer to the memory block. */
+  ++(m->count[i]);
+#if MEMB_STATS
+  if(++m->used > m->max_used) {
+    m->max_used = m->used;
+  }
+#endif
+  return (void *)((char *)m->mem + (i * m->size));
 }
 /*---------------------------------------------------------------------------*/
 char
 memb_free(struct memb *m, void *ptr)
 {
-  int i;
-  char *ptr2;
+  int i = block_index(m, ptr);
 
-  /* Walk through the list of blocks and try to find the block to
-     which the pointer "ptr" points to. */
-  ptr2 = (char *)m->mem;
-  for(i = 0; i < m->num; ++i) {
-    
-    if(ptr2 == (char *)ptr) {
-      /* We've found to block to which "ptr" points so we decrease the
-	 reference count and return the new value of it. */
-      if(m->count[i] > 0) {
-	/* Make sure that we don't deallocate free memory. */
-	--(m->count[i]);
+  if(i < 0) {
+    return -1;
+  }
+
+  /* Decrease the reference count of the block and return the new
+     value of it. Make sure that we don't deallocate free memory. */
+  if(m->count[i] > 0) {
+    if(--(m->count[i]) == 0) {
+#if MEMB_WITH_FREELIST
+      if(m->freelist != NULL) {
+        m->freelist->next[i] = m->freelist->free;
+        m->freelist->free = i + 1;
       }
-      return m->count[i];
+#endif /* MEMB_WITH_FREELIST */
+#if MEMB_STATS
+      m->used--;
+#endif
     }
-    ptr2 += m->size;
   }
-  return -1;
+  return m->count[i];
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -110,6 +171,9 @@ memb_inmemb(struct memb *m, void *ptr)
 int
 memb_numfree(struct memb *m)
 {
+#if MEMB_STATS
+  return m->num - m->used;
+#else
   int i;
   int num_free = 0;
 
@@ -120,5 +184,21 @@ memb_numfree(struct memb *m)
   }
 
   return num_free;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+#if MEMB_STATS
+int
+memb_watermark(struct memb *m)
+{
+  return m->max_used;
 }
+/*---------------------------------------------------------------------------*/
+int
+memb_failures(struct memb *m)
+{
+  return m->failures;
+}
+#endif /* MEMB_STATS */
+/*---------------------------------------------------------------------------*/
 /** @} */
@@ -48,6 +48,21 @@
  * memory by the memb_alloc() function, and are deallocated with the
  * memb_free() function.
  *
+ * Blocks of pools declared with MEMB() are found by scanning the
+ * reference counts, which costs O(n) per allocation. With
+ * MEMB_CONF_WITH_FREELIST set to 1, pools declared with
+ * MEMB_FREELIST() keep free blocks in a list of indices, so
+ * allocation and deallocation take constant time for the price of two
+ * bytes of RAM per block. Every pool then holds a pointer to its
+ * free-list state, which is NULL for MEMB() pools. Without it
+ * MEMB_FREELIST() declares a plain pool. Setting MEMB_CONF_FREELIST
+ * to 1 turns every MEMB() pool into a free-list pool. Blocks of
+ * free-list pools are reused in LIFO order instead of lowest address
+ * first.
+ *
+ * With MEMB_CONF_STATS set to 1 every pool counts its high watermark
+ * of used blocks and failed allocations.
+ *
  * @{
  */
 
@@ -65,6 +80,28 @@
 
 #include "sys/cc.h"
 
+#ifdef MEMB_CONF_FREELIST
+#define MEMB_FREELIST_DEFAULT MEMB_CONF_FREELIST
+#else
+#define MEMB_FREELIST_DEFAULT 0
+#endif
+
+#ifdef MEMB_CONF_WITH_FREELIST
+#define MEMB_WITH_FREELIST MEMB_CONF_WITH_FREELIST
+#else
+#define MEMB_WITH_FREELIST MEMB_FREELIST_DEFAULT
+#endif
+
+#if MEMB_FREELIST_DEFAULT && !MEMB_WITH_FREELIST
+#error MEMB_CONF_FREELIST needs MEMB_CONF_WITH_FREELIST
+#endif
+
+#ifdef MEMB_CONF_STATS
+#define MEMB_STATS MEMB_CONF_STATS
+#else
+#define MEMB_STATS 0
+#endif
+
 /**
  * Declare a memory block.
  *
@@ -86,18 +123,66 @@ MEMB(connections, struct connection, 16);
  * \param num The total number of memory chunks in the block.
  *
  */
+#if MEMB_FREELIST_DEFAULT
+#define MEMB(name, structure, num) MEMB_FREELIST(name, structure, num)
+#else
 #define MEMB(name, structure, num) \
         static char CC_CONCAT(name,_memb_count)[num]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_count), \
                                           (void *)CC_CONCAT(name,_memb_mem)}
+#endif
+
+/**
+ * Declare a memory block with constant time allocation.
+ *
+ * Same as MEMB(), with MEMB_CONF_WITH_FREELIST blocks are allocated
+ * and deallocated by memb_alloc() and memb_free() in constant
+ * time. The pool is usable without calling memb_init().
+ */
+#if MEMB_WITH_FREELIST
+#define MEMB_FREELIST(name, structure, num) \
+        static char CC_CONCAT(name,_memb_count)[num]; \
+        static structure CC_CONCAT(name,_memb_mem)[num]; \
+        static unsigned short CC_CONCAT(name,_memb_next)[num]; \
+        static struct memb_freelist CC_CONCAT(name,_memb_freelist) = \
+          {CC_CONCAT(name,_memb_next)}; \
+        static struct memb name = {sizeof(structure), num, \
+                                          CC_CONCAT(name,_memb_count), \
+                                          (void *)CC_CONCAT(name,_memb_mem), \
+                                          &CC_CONCAT(name,_memb_freelist)}
+#else /* MEMB_WITH_FREELIST */
+#define MEMB_FREELIST(name, structure, num) MEMB(name, structure, num)
+#endif /* MEMB_WITH_FREELIST */
+
+#if MEMB_WITH_FREELIST
+/* Free-list state of a pool declared with MEMB_FREELIST() */
+struct memb_freelist {
+  /* Free-list links (block index + 1) */
+  unsigned short *next;
+  /* Head of the free list (block index + 1), 0 if the list is empty */
+  unsigned short free;
+  /* Blocks from this index up have never been allocated since
+     memb_init() and are not linked into the free list */
+  unsigned short top;
+};
+#endif /* MEMB_WITH_FREELIST */
 
 struct memb {
   unsigned short size;
   unsigned short num;
   char *count;
   void *mem;
+#if MEMB_WITH_FREELIST
+  /* NULL for pools declared with MEMB() */
+  struct memb_freelist *freelist;
+#endif /* MEMB_WITH_FREELIST */
+#if MEMB_STATS
+  unsigned short used;
+  unsigned short max_used;
+  unsigned short failures;
+#endif
 };
 
 /**
@@ -132,6 +217,20 @@ int memb_inmemb(struct memb *m, void *ptr);
 
 int  memb_numfree(struct memb *m);
 
+#if MEMB_STATS
+/**
+ * Get the highest number of blocks that were in use at the same time
+ * since memb_init().
+ */
+int memb_watermark(struct memb *m);
+
+/**
+ * Get the number of memb_alloc() calls that failed because all
+ * blocks were in use.
+ */
+int memb_failures(struct memb *m);
+#endif /* MEMB_STATS */
+
 /** @} */
 /** @} */
 
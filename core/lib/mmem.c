@@ -55,6 +55,43 @@
 #define MMEM_SIZE 4096
 #endif
 
+#if MMEM_CONF_HEAPMEM
+/* Blocks come from the bounded-time heap and never move, so there is
+   nothing to compact. The heap arena is sized with
+   HEAPMEM_CONF_ARENA_SIZE. */
+#include "lib/heapmem.h"
+
+int
+mmem_alloc(struct mmem *m, unsigned int size)
+{
+  m->ptr = heapmem_alloc(size);
+  if(m->ptr == NULL) {
+    return 0;
+  }
+  m->size = size;
+  m->next = NULL;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+mmem_free(struct mmem *m)
+{
+  heapmem_free(m->ptr);
+  m->ptr = NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+mmem_init(void)
+{
+  static int inited = 0;
+  if(inited) {
+    return;
+  }
+  heapmem_init();
+  inited = 1;
+}
+/*---------------------------------------------------------------------------*/
+#else /* MMEM_CONF_HEAPMEM */
 LIST(mmemlist);
 unsigned int avail_memory;
 static char memory[MMEM_SIZE];
@@ -160,5 +197,6 @@ mmem_init(void)
   inited = 1;
 }
 /*---------------------------------------------------------------------------*/
+#endif /* MMEM_CONF_HEAPMEM */
 
 /** @} */
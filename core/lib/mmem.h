@@ -44,6 +44,11 @@
  * stays in place. Therefore, a level of indirection is used: access
  * to allocated memory must always be done using a special macro.
  *
+ * Freeing a block moves all blocks allocated after it, which takes
+ * time proportional to the allocated memory. With MMEM_CONF_HEAPMEM
+ * set, blocks are allocated from the \ref heapmem "bounded-time heap"
+ * instead and are never moved.
+ *
  * \note This module has not been heavily tested.
  * @{
  */
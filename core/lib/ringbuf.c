@@ -39,6 +39,7 @@
 
 #include "lib/ringbuf.h"
 #include <sys/cc.h>
+#include <string.h>
 /*---------------------------------------------------------------------------*/
 void
 ringbuf_init(struct ringbuf *r, uint8_t *dataptr, uint8_t size)
@@ -72,6 +73,7 @@ ringbuf_put(struct ringbuf *r, uint8_t c)
    * better safe than sorry.
    */
   CC_ACCESS_NOW(uint8_t, r->data[r->put_ptr]) = c;
+  CC_MEMORY_BARRIER();
   CC_ACCESS_NOW(uint8_t, r->put_ptr) = (r->put_ptr + 1) & r->mask;
   return 1;
 }
@@ -102,6 +104,7 @@ ringbuf_get(struct ringbuf *r)
      * (on some architectures).
      */
     c = CC_ACCESS_NOW(uint8_t, r->data[r->get_ptr]);
+    CC_MEMORY_BARRIER();
     CC_ACCESS_NOW(uint8_t, r->get_ptr) = (r->get_ptr + 1) & r->mask;
     return c;
   } else {
@@ -121,3 +124,89 @@ ringbuf_elements(struct ringbuf *r)
   return (r->put_ptr - r->get_ptr) & r->mask;
 }
 /*---------------------------------------------------------------------------*/
+/*
+ * The bulk functions follow the same rules as ringbuf_put() and
+ * ringbuf_get(): the producer only writes put_ptr, the consumer only
+ * writes get_ptr, and each side reads the index of the other side
+ * once, before it touches the data. The barrier before an index is
+ * published makes the data access visible first.
+ */
+/*---------------------------------------------------------------------------*/
+int
+ringbuf_peek_put(struct ringbuf *r, uint8_t **span)
+{
+  uint8_t put_ptr = r->put_ptr;
+  uint8_t get_ptr = CC_ACCESS_NOW(uint8_t, r->get_ptr);
+  int space = r->mask - ((put_ptr - get_ptr) & r->mask);
+  int contiguous = r->mask + 1 - put_ptr;
+
+  /* Bytes the consumer released must not be overwritten before it
+     is done reading them */
+  CC_MEMORY_BARRIER();
+  *span = &r->data[put_ptr];
+  return space < contiguous ? space : contiguous;
+}
+/*---------------------------------------------------------------------------*/
+void
+ringbuf_commit_put(struct ringbuf *r, int n)
+{
+  CC_MEMORY_BARRIER();
+  CC_ACCESS_NOW(uint8_t, r->put_ptr) = (r->put_ptr + n) & r->mask;
+}
+/*---------------------------------------------------------------------------*/
+int
+ringbuf_peek_get(struct ringbuf *r, const uint8_t **span)
+{
+  uint8_t get_ptr = r->get_ptr;
+  uint8_t put_ptr = CC_ACCESS_NOW(uint8_t, r->put_ptr);
+  int elements = (put_ptr - get_ptr) & r->mask;
+  int contiguous = r->mask + 1 - get_ptr;
+
+  /* Data must not be read before the index that published it */
+  CC_MEMORY_BARRIER();
+  *span = &r->data[get_ptr];
+  return elements < contiguous ? elements : contiguous;
+}
+/*---------------------------------------------------------------------------*/
+void
+ringbuf_commit_get(struct ringbuf *r, int n)
+{
+  CC_MEMORY_BARRIER();
+  CC_ACCESS_NOW(uint8_t, r->get_ptr) = (r->get_ptr + n) & r->mask;
+}
+/*---------------------------------------------------------------------------*/
+int
+ringbuf_put_n(struct ringbuf *r, const uint8_t *data, int len)
+{
+  uint8_t *span;
+  int n, total = 0;
+
+  /* At most two spans, before and after the end of the array */
+  while(total < len && (n = ringbuf_peek_put(r, &span)) > 0) {
+    if(n > len - total) {
+      n = len - total;
+    }
+    memcpy(span, data + total, n);
+    ringbuf_commit_put(r, n);
+    total += n;
+  }
+  return total;
+}
+/*---------------------------------------------------------------------------*/
+int
+ringbuf_get_n(struct ringbuf *r, uint8_t *data, int len)
+{
+  const uint8_t *span;
+  int n, total = 0;
+
+  while(total < len && (n = ringbuf_peek_get(r, &span)) > 0) {
+    if(n > len - total) {
+      n = len - total;
+    }
+    memcpy(data + total, span, n);
+    ringbuf_commit_get(r, n);
+    total += n;
+  }
+  return total;
+}
+/*---------------------------------------------------------------------------*/
@@ -129,6 +129,76 @@ int     ringbuf_size(struct ringbuf *r);
  */
 int     ringbuf_elements(struct ringbuf *r);
 
+/**
+ * \name Bulk and zero-copy access
+ *
+ * These functions move many bytes at once. They are safe with one
+ * producer and one consumer running concurrently, e.g. an interrupt
+ * handler and a process: the producer may only call the put
+ * functions and the consumer only the get functions. Accesses to the
+ * data are ordered against the index updates with
+ * CC_MEMORY_BARRIER(), so DMA and other cores see them in order too.
+ * @{
+ */
+
+/**
+ * \brief      Get the contiguous free space at the end of the buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param span Set to the first free byte
+ * \return     Number of bytes that can be written starting at span
+ *
+ *             The bytes are added to the buffer by
+ *             ringbuf_commit_put(). Free space that wraps around the
+ *             end of the array is returned by the next call after the
+ *             commit.
+ */
+int     ringbuf_peek_put(struct ringbuf *r, uint8_t **span);
+
+/**
+ * \brief      Add bytes written to the span from ringbuf_peek_put()
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param n    Number of bytes, at most the length of the span
+ */
+void    ringbuf_commit_put(struct ringbuf *r, int n);
+
+/**
+ * \brief      Get the contiguous data at the start of the buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param span Set to the first byte in the buffer
+ * \return     Number of bytes that can be read starting at span
+ *
+ *             The bytes stay in the buffer until ringbuf_commit_get()
+ *             is called.
+ */
+int     ringbuf_peek_get(struct ringbuf *r, const uint8_t **span);
+
+/**
+ * \brief      Remove bytes read from the span from ringbuf_peek_get()
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param n    Number of bytes, at most the length of the span
+ */
+void    ringbuf_commit_get(struct ringbuf *r, int n);
+
+/**
+ * \brief      Insert bytes into the ring buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param data The bytes to be written
+ * \param len  Number of bytes
+ * \return     Number of bytes written, less than len if the buffer got full
+ */
+int     ringbuf_put_n(struct ringbuf *r, const uint8_t *data, int len);
+
+/**
+ * \brief      Get bytes from the ring buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param data Where the bytes are copied to
+ * \param len  Maximum number of bytes
+ * \return     Number of bytes copied
+ */
+int     ringbuf_get_n(struct ringbuf *r, uint8_t *data, int len);
+
+/** @} */
+
 #endif /* RINGBUF_H_ */
 
 /** @}*/
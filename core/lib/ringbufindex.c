@@ -44,6 +44,7 @@
 
 #include <string.h>
 #include "lib/ringbufindex.h"
+#include "sys/cc.h"
 
 /* Initialize a ring buffer. The size must be a power of two */
 void
@@ -147,3 +148,53 @@ ringbufindex_empty(const struct ringbufindex *r)
 {
   return ringbufindex_elements(r) == 0;
 }
+/* Return the number of free elements following the put index without
+ * wrapping, the index itself is stored in index */
+int
+ringbufindex_peek_put_n(const struct ringbufindex *r, uint8_t *index)
+{
+  uint8_t put_ptr = r->put_ptr;
+  uint8_t get_ptr = CC_ACCESS_NOW(uint8_t, r->get_ptr);
+  int space = r->mask - ((put_ptr - get_ptr) & r->mask);
+  int contiguous = r->mask + 1 - put_ptr;
+
+  CC_MEMORY_BARRIER();
+  *index = put_ptr;
+  return space < contiguous ? space : contiguous;
+}
+/* Put n elements to the ring buffer */
+int
+ringbufindex_put_n(struct ringbufindex *r, int n)
+{
+  if(n < 0 || n > r->mask - ((r->put_ptr - r->get_ptr) & r->mask)) {
+    return 0;
+  }
+  CC_MEMORY_BARRIER();
+  CC_ACCESS_NOW(uint8_t, r->put_ptr) = (r->put_ptr + n) & r->mask;
+  return 1;
+}
+/* Return the number of elements following the get index without
+ * wrapping, the index itself is stored in index */
+int
+ringbufindex_peek_get_n(const struct ringbufindex *r, uint8_t *index)
+{
+  uint8_t get_ptr = r->get_ptr;
+  uint8_t put_ptr = CC_ACCESS_NOW(uint8_t, r->put_ptr);
+  int elements = (put_ptr - get_ptr) & r->mask;
+  int contiguous = r->mask + 1 - get_ptr;
+
+  CC_MEMORY_BARRIER();
+  *index = get_ptr;
+  return elements < contiguous ? elements : contiguous;
+}
+/* Remove the first n elements */
+int
+ringbufindex_get_n(struct ringbufindex *r, int n)
+{
+  if(n < 0 || n > ((r->put_ptr - r->get_ptr) & r->mask)) {
+    return 0;
+  }
+  CC_MEMORY_BARRIER();
+  CC_ACCESS_NOW(uint8_t, r->get_ptr) = (r->get_ptr + n) & r->mask;
+  return 1;
+}
@@ -116,4 +116,45 @@ int ringbufindex_full(const struct ringbufindex *r);
  */
 int ringbufindex_empty(const struct ringbufindex *r);
 
+/*
+ * Bulk access. With one producer calling the put functions and one
+ * consumer calling the get functions, e.g. an interrupt handler and a
+ * process, no locking is needed: element accesses are ordered against
+ * index updates with CC_MEMORY_BARRIER().
+ */
+
+/**
+ * \brief Return the free elements that can be filled without wrapping
+ * \param r Pointer to ringbufindex
+ * \param index Set to the index of the first free element
+ * \return Number of free elements from index to the end of the array
+ */
+int ringbufindex_peek_put_n(const struct ringbufindex *r, uint8_t *index);
+
+/**
+ * \brief Put n elements to the ring buffer, after they were filled
+ * \param r Pointer to ringbufindex
+ * \param n Number of elements
+ * \retval 0 Failure; there is not enough space
+ * \retval 1 Success; the elements are added
+ */
+int ringbufindex_put_n(struct ringbufindex *r, int n);
+
+/**
+ * \brief Return the elements that can be read without wrapping
+ * \param r Pointer to ringbufindex
+ * \param index Set to the index of the first element
+ * \return Number of elements from index to the end of the array
+ */
+int ringbufindex_peek_get_n(const struct ringbufindex *r, uint8_t *index);
+
+/**
+ * \brief Remove the first n elements from the ring buffer
+ * \param r Pointer to ringbufindex
+ * \param n Number of elements
+ * \retval 0 Failure; there are fewer elements
+ * \retval 1 Success; the elements are removed
+ */
+int ringbufindex_get_n(struct ringbufindex *r, int n);
+
 #endif /* __RINGBUFINDEX_H__ */
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ * Author: Tomas Hermanek
+ */
+
+/**
+ * \file
+ * Tail list library implementation.
+ *
+ * \author Tomas Hermanek
+ *
+ */
+
+/**
+ * \addtogroup tlist
+ * @{
+ */
+
+#include "lib/tlist.h"
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+struct item {
+  struct item *next;
+  struct item *prev;
+};
+
+/*---------------------------------------------------------------------------*/
+/**
+ * Initialize a list, the list will be empty afterwards.
+ *
+ * \param list The list to be initialized.
+ */
+void
+tlist_init(tlist_t list)
+{
+  list->head = list->tail = NULL;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get a pointer to the first element of a list.
+ *
+ * \param list The list.
+ * \return A pointer to the first element on the list.
+ */
+void *
+tlist_head(tlist_t list)
+{
+  return list->head;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get a pointer to the last element of a list.
+ *
+ * \param list The list.
+ * \return A pointer to the last element on the list.
+ */
+void *
+tlist_tail(tlist_t list)
+{
+  return list->tail;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Add an item at the end of a list.
+ *
+ * \param list The list.
+ * \param item A pointer to the item, it must not be on the list.
+ */
+void
+tlist_add(tlist_t list, void *item)
+{
+  struct item *i = item;
+
+  i->next = NULL;
+  if(list->linked) {
+    i->prev = list->tail;
+  }
+  if(list->tail != NULL) {
+    ((struct item *)list->tail)->next = i;
+  } else {
+    list->head = i;
+  }
+  list->tail = i;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Add an item to the start of a list.
+ *
+ * \param list The list.
+ * \param item A pointer to the item, it must not be on the list.
+ */
+void
+tlist_push(tlist_t list, void *item)
+{
+  struct item *i = item;
+
+  i->next = list->head;
+  if(list->linked) {
+    i->prev = NULL;
+    if(list->head != NULL) {
+      ((struct item *)list->head)->prev = i;
+    }
+  }
+  list->head = i;
+  if(list->tail == NULL) {
+    list->tail = i;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove the first object on a list.
+ *
+ * \param list The list.
+ * \return Pointer to the removed element of list.
+ */
+void *
+tlist_pop(tlist_t list)
+{
+  struct item *i = list->head;
+
+  if(i != NULL) {
+    list->head = i->next;
+    if(list->head == NULL) {
+      list->tail = NULL;
+    } else if(list->linked) {
+      ((struct item *)list->head)->prev = NULL;
+    }
+    i->next = NULL;
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove the last object on a list, in constant time on doubly
+ * linked lists.
+ *
+ * \param list The list.
+ * \return Pointer to the removed element of list.
+ */
+void *
+tlist_chop(tlist_t list)
+{
+  struct item *i = list->tail;
+
+  if(i == NULL || i == list->head) {
+    return tlist_pop(list);
+  }
+  list->tail = tlist_item_prev(list, i);
+  ((struct item *)list->tail)->next = NULL;
+  if(list->linked) {
+    i->prev = NULL;
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Remove a specific element from a list, in constant time on doubly
+ * linked lists. On doubly linked lists the item must be on the list
+ * or its links must be NULL.
+ *
+ * \param list The list.
+ * \param item The item that is to be removed from the list.
+ */
+void
+tlist_remove(tlist_t list, void *item)
+{
+  struct item *i = item;
+  struct item *p;
+
+  if(list->linked) {
+    p = i->prev;
+    if(p == NULL && list->head != i) {
+      /* Not on the list */
+      return;
+    }
+    if(i->next != NULL) {
+      i->next->prev = p;
+    }
+  } else {
+    if(list->head == i) {
+      p = NULL;
+    } else {
+      for(p = list->head; p != NULL && p->next != i; p = p->next);
+      if(p == NULL) {
+        return;
+      }
+    }
+  }
+
+  if(p == NULL) {
+    list->head = i->next;
+  } else {
+    p->next = i->next;
+  }
+  if(list->tail == i) {
+    list->tail = p;
+  }
+  i->next = NULL;
+  if(list->linked) {
+    i->prev = NULL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * Get the length of a list.
+ *
+ * \param list The list.
+ * \return The length of the list.
+ */
+int
+tlist_length(tlist_t list)
+{
+  struct item *i;
+  int n = 0;
+
+  for(i = list->head; i != NULL; i = i->next) {
+    ++n;
+  }
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Insert an item after a specified item on the list
+ * \param list The list
+ * \param previtem The item after which the new item should be inserted,
+ *             NULL places the new item at the start of the list
+ * \param newitem  The new item that is to be inserted
+ */
+void
+tlist_insert(tlist_t list, void *previtem, void *newitem)
+{
+  struct item *p = previtem;
+  struct item *i = newitem;
+
+  if(p == NULL) {
+    tlist_push(list, i);
+    return;
+  }
+  i->next = p->next;
+  p->next = i;
+  if(list->linked) {
+    i->prev = p;
+    if(i->next != NULL) {
+      i->next->prev = i;
+    }
+  }
+  if(list->tail == p) {
+    list->tail = i;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Get the next item following this item
+ * \param item A list item
+ * \returns    A next item on the list
+ */
+void *
+tlist_item_next(void *item)
+{
+  return item == NULL ? NULL : ((struct item *)item)->next;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief      Get the item preceding this item
+ * \param list The list
+ * \param item A list item
+ * \returns    A previous item on the list, NULL for the first one
+ *
+ *             Constant time on doubly linked lists, a scan otherwise.
+ */
+void *
+tlist_item_prev(tlist_t list, void *item)
+{
+  struct item *p;
+
+  if(item == NULL || list->head == item) {
+    return NULL;
+  }
+  if(list->linked) {
+    return ((struct item *)item)->prev;
+  }
+  for(p = list->head; p != NULL && p->next != item; p = p->next);
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+/** @} */
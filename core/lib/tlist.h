@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ * Author: Tomas Hermanek
+ */
+
+/**
+ * \file
+ * Linked list with head and tail pointers.
+ * \author Tomas Hermanek
+ *
+ */
+
+/** \addtogroup lib
+    @{ */
+/**
+ * \defgroup tlist Tail list library
+ *
+ * The tail list library is a companion of the \ref list "linked list
+ * library" for lists that are appended to or unlinked from often. A
+ * tail list keeps pointers to both its first and last element, so
+ * tlist_add(), tlist_push(), tlist_pop() and tlist_tail() take
+ * constant time.
+ *
+ * Lists declared with DLIST() are doubly linked: their elements \b
+ * must start with two pointers, next and prev. On these lists
+ * tlist_remove() and tlist_chop() take constant time too. Elements of
+ * lists declared with TLIST() only need the next pointer and removal
+ * scans the list.
+ *
+ * Unlike list_add(), tlist_add() does not check whether the element
+ * already is on the list. Elements are linked through their next
+ * pointer, so lists can be walked with tlist_item_next() or
+ * list_item_next().
+ *
+ * @{
+ */
+
+#ifndef TLIST_H_
+#define TLIST_H_
+
+#include "lib/list.h"
+
+/**
+ * The tail list.
+ */
+struct tlist {
+  void *head, *tail;
+  unsigned char linked;
+};
+
+typedef struct tlist * tlist_t;
+
+/**
+ * Declare a singly linked tail list.
+ *
+ * \param name The name of the list.
+ */
+#define TLIST(name) \
+         static struct tlist LIST_CONCAT(name,_tlist) = { NULL, NULL, 0 }; \
+         static tlist_t name = &LIST_CONCAT(name,_tlist)
+
+/**
+ * Declare a doubly linked tail list.
+ *
+ * \param name The name of the list.
+ */
+#define DLIST(name) \
+         static struct tlist LIST_CONCAT(name,_tlist) = { NULL, NULL, 1 }; \
+         static tlist_t name = &LIST_CONCAT(name,_tlist)
+
+/**
+ * Declare a tail list inside a structure declaration. The list is
+ * initialized with TLIST_STRUCT_INIT() or DLIST_STRUCT_INIT(), the
+ * list functions take a pointer to it.
+ *
+ * \param name The name of the list.
+ */
+#define TLIST_STRUCT(name) struct tlist name
+
+#define TLIST_STRUCT_INIT(struct_ptr, name)                             \
+    do {                                                                \
+       (struct_ptr)->name.linked = 0;                                   \
+       tlist_init(&(struct_ptr)->name);                                 \
+    } while(0)
+
+#define DLIST_STRUCT_INIT(struct_ptr, name)                             \
+    do {                                                                \
+       (struct_ptr)->name.linked = 1;                                   \
+       tlist_init(&(struct_ptr)->name);                                 \
+    } while(0)
+
+void   tlist_init(tlist_t list);
+void * tlist_head(tlist_t list);
+void * tlist_tail(tlist_t list);
+void * tlist_pop(tlist_t list);
+void   tlist_push(tlist_t list, void *item);
+
+void * tlist_chop(tlist_t list);
+
+void   tlist_add(tlist_t list, void *item);
+void   tlist_remove(tlist_t list, void *item);
+
+int    tlist_length(tlist_t list);
+
+void   tlist_insert(tlist_t list, void *previtem, void *newitem);
+
+void * tlist_item_next(void *item);
+void * tlist_item_prev(tlist_t list, void *item);
+
+#endif /* TLIST_H_ */
+
+/** @} */
+/** @} */
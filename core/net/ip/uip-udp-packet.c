@@ -51,14 +51,18 @@ extern uint16_t uip_slen;
 
 /*---------------------------------------------------------------------------*/
 void
-uip_udp_packet_forward(uip_ipaddr_t from, uip_ipaddr_t to, uint16_t remote_port, uint16_t src_port, const void *data, int len) {
+uip_udp_packet_forward(const uip_ipaddr_t *from, const uip_ipaddr_t *to, uint16_t remote_port, uint16_t src_port,
+                       const void *data, int len) {
 #if UIP_UDP
-    if(data != NULL && len <= (UIP_BUFSIZE - (UIP_LLH_LEN + UIP_IPUDPH_LEN))) {
+    if(data != NULL && len <= UIP_UDP_PACKET_MAX_PAYLOAD) {
         //uip_udp_conn->ripaddr = to;
         uip_udp_conn = NULL;
 
         uip_slen = len;
-        memmove(&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN], data, len);
+        /* Payload built directly in uip_buf by caller is not moved */
+        if(data != UIP_UDP_PACKET_PAYLOAD) {
+            memmove(UIP_UDP_PACKET_PAYLOAD, data, len);
+        }
 
 
         uip_process(UIP_UDP_SEND_CONN);
@@ -76,8 +80,8 @@ uip_udp_packet_forward(uip_ipaddr_t from, uip_ipaddr_t to, uint16_t remote_port,
         UIP_UDP_BUF->srcport  = UIP_HTONS(src_port);
         UIP_UDP_BUF->destport = UIP_HTONS(remote_port);
 
-        uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &to);
-        uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &from);
+        uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, to);
+        uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, from);
 //        uip_ds6_select_src(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
 
         uip_appdata = &uip_buf[UIP_LLH_LEN + UIP_IPTCPH_LEN];
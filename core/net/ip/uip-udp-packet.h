@@ -42,8 +42,16 @@
 
 #include "net/ip/uip.h"
 
+/* Payload area of an outgoing UDP packet in uip_buf and its maximum length.
+   Callers may build the payload there to avoid copying it. */
+#define UIP_UDP_PACKET_PAYLOAD     (&uip_buf[UIP_LLH_LEN + UIP_IPUDPH_LEN])
+#define UIP_UDP_PACKET_MAX_PAYLOAD (UIP_BUFSIZE - (UIP_LLH_LEN + UIP_IPUDPH_LEN))
+
 void uip_udp_packet_send(struct uip_udp_conn *c, const void *data, int len);
 void uip_udp_packet_sendto(struct uip_udp_conn *c, const void *data, int len,
 			   const uip_ipaddr_t *toaddr, uint16_t toport);
+void uip_udp_packet_forward(const uip_ipaddr_t *from, const uip_ipaddr_t *to,
+                            uint16_t remote_port, uint16_t src_port,
+                            const void *data, int len);
 
 #endif /* UIP_UDP_PACKET_H_ */
@@ -42,6 +42,7 @@
 #include "net/ip/uip.h"
 
 #include "lib/list.h"
+#include "lib/tlist.h"
 #include "lib/memb.h"
 #include "net/nbr-table.h"
 
@@ -68,10 +69,31 @@ MEMB(neighborroutememb, struct uip_ds6_route_neighbor_route, UIP_DS6_ROUTE_NB);
 
 /* Each route is repressented by a uip_ds6_route_t structure and
    memory for each route is allocated from the routememb memory
-   block. These routes are maintained on the routelist. */
-LIST(routelist);
+   block. These routes are maintained on the routelist, which is
+   doubly linked so that moving a route to the front and dropping the
+   least recently used one take constant time. */
+DLIST(routelist);
 MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 
+#if UIP_DS6_ROUTE_WITH_INDEX
+/* The longest prefix match index hashes every route by its prefix and
+   length, and keeps the distinct prefix lengths in use, longest
+   first. A lookup probes the hash once per length until a route
+   matches. Chains link route indexes in routememb, stored as index + 1
+   so that 0 ends a chain. */
+#if UIP_DS6_ROUTE_NB < 255
+typedef uint8_t route_index_t;
+#else
+typedef uint16_t route_index_t;
+#endif
+#define ROUTE_LENGTHS (UIP_DS6_ROUTE_NB < 129 ? UIP_DS6_ROUTE_NB : 129)
+static route_index_t route_buckets[UIP_DS6_ROUTE_HASH_SIZE];
+static route_index_t route_next[UIP_DS6_ROUTE_NB];
+static uint8_t lengths[ROUTE_LENGTHS];
+static route_index_t length_count[ROUTE_LENGTHS];
+static uint8_t num_lengths;
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
+
 static int num_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
@@ -161,7 +183,11 @@ uip_ds6_route_init(void)
 {
 #if (UIP_CONF_MAX_ROUTES != 0)
   memb_init(&routememb);
-  list_init(routelist);
+  tlist_init(routelist);
+#if UIP_DS6_ROUTE_WITH_INDEX
+  memset(route_buckets, 0, sizeof(route_buckets));
+  num_lengths = 0;
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -174,6 +200,87 @@ uip_ds6_route_init(void)
 #endif
 }
 #if (UIP_CONF_MAX_ROUTES != 0)
+#if UIP_DS6_ROUTE_WITH_INDEX
+/*---------------------------------------------------------------------------*/
+/* uip_ipaddr_prefixcmp() compares whole bytes, so does the hash */
+static unsigned
+prefix_hash(const uip_ipaddr_t *addr, uint8_t length)
+{
+  uint16_t h = length;
+  int i;
+
+  for(i = 0; i < (length >> 3); i++) {
+    h = (h << 5) + h + addr->u8[i];
+  }
+  return h % UIP_DS6_ROUTE_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_add(uip_ds6_route_t *r)
+{
+  unsigned bucket = prefix_hash(&r->ipaddr, r->length);
+  int index = r - (uip_ds6_route_t *)routememb.mem;
+  int i;
+
+  route_next[index] = route_buckets[bucket];
+  route_buckets[bucket] = index + 1;
+
+  for(i = 0; i < num_lengths && lengths[i] > r->length; i++);
+  if(i == num_lengths || lengths[i] != r->length) {
+    memmove(&lengths[i + 1], &lengths[i], num_lengths - i);
+    memmove(&length_count[i + 1], &length_count[i],
+            (num_lengths - i) * sizeof(route_index_t));
+    lengths[i] = r->length;
+    length_count[i] = 0;
+    num_lengths++;
+  }
+  length_count[i]++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_rm(uip_ds6_route_t *r)
+{
+  route_index_t *p = &route_buckets[prefix_hash(&r->ipaddr, r->length)];
+  int index = r - (uip_ds6_route_t *)routememb.mem;
+  int i;
+
+  while(*p != 0 && *p != index + 1) {
+    p = &route_next[*p - 1];
+  }
+  if(*p == 0) {
+    return;
+  }
+  *p = route_next[index];
+
+  for(i = 0; i < num_lengths && lengths[i] != r->length; i++);
+  if(i < num_lengths && --length_count[i] == 0) {
+    num_lengths--;
+    memmove(&lengths[i], &lengths[i + 1], num_lengths - i);
+    memmove(&length_count[i], &length_count[i + 1],
+            (num_lengths - i) * sizeof(route_index_t));
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uip_ds6_route_t *
+index_lookup(const uip_ipaddr_t *addr)
+{
+  uip_ds6_route_t *r;
+  route_index_t index;
+  int i;
+
+  for(i = 0; i < num_lengths; i++) {
+    for(index = route_buckets[prefix_hash(addr, lengths[i])]; index != 0;
+        index = route_next[index - 1]) {
+      r = &((uip_ds6_route_t *)routememb.mem)[index - 1];
+      if(r->length == lengths[i] &&
+         uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
+        return r;
+      }
+    }
+  }
+  return NULL;
+}
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
 /*---------------------------------------------------------------------------*/
 static uip_lladdr_t *
 uip_ds6_route_nexthop_lladdr(uip_ds6_route_t *route)
@@ -205,7 +312,7 @@ uip_ds6_route_t *
 uip_ds6_route_head(void)
 {
 #if (UIP_CONF_MAX_ROUTES != 0)
-  return list_head(routelist);
+  return tlist_head(routelist);
 #else /* (UIP_CONF_MAX_ROUTES != 0) */
   return NULL;
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -254,15 +361,19 @@ uip_ds6_route_t *
 uip_ds6_route_lookup(uip_ipaddr_t *addr)
 {
 #if (UIP_CONF_MAX_ROUTES != 0)
-  uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
+#if !UIP_DS6_ROUTE_WITH_INDEX
+  uip_ds6_route_t *r;
   uint8_t longestmatch;
+#endif /* !UIP_DS6_ROUTE_WITH_INDEX */
 
   PRINTF("uip-ds6-route: Looking up route for ");
   PRINT6ADDR(addr);
   PRINTF("\n");
 
-
+#if UIP_DS6_ROUTE_WITH_INDEX
+  found_route = index_lookup(addr);
+#else /* UIP_DS6_ROUTE_WITH_INDEX */
   found_route = NULL;
   longestmatch = 0;
   for(r = uip_ds6_route_head();
@@ -278,6 +389,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
       }
     }
   }
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
 
   if(found_route != NULL) {
     PRINTF("uip-ds6-route: Found route: ");
@@ -289,14 +401,14 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     PRINTF("uip-ds6-route: No route found\n");
   }
 
-  if(found_route != NULL && found_route != list_head(routelist)) {
+  if(found_route != NULL && found_route != tlist_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
        the least recently used route will be at the end of the
        list - for fast lookups (assuming multiple packets to the same node). */
 
-    list_remove(routelist, found_route);
-    list_push(routelist, found_route);
+    tlist_remove(routelist, found_route);
+    tlist_push(routelist, found_route);
   }
 
   return found_route;
@@ -305,11 +417,11 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
 }
 /*---------------------------------------------------------------------------*/
-uip_ds6_route_t *
-uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
-		  uip_ipaddr_t *nexthop)
-{
 #if (UIP_CONF_MAX_ROUTES != 0)
+static uip_ds6_route_t *
+add_route(uip_ipaddr_t *ipaddr, uint8_t length, uip_ipaddr_t *nexthop,
+          const uip_lladdr_t *nexthop_lladdr)
+{
   uip_ds6_route_t *r;
   struct uip_ds6_route_neighbor_route *nbrr;
 
@@ -317,15 +429,6 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
   assert_nbr_routes_list_sane();
 #endif /* DEBUG != DEBUG_NONE */
 
-  /* Get link-layer address of next hop, make sure it is in neighbor table */
-  const uip_lladdr_t *nexthop_lladdr = uip_ds6_nbr_lladdr_from_ipaddr(nexthop);
-  if(nexthop_lladdr == NULL) {
-    PRINTF("uip_ds6_route_add: neighbor link-local address unknown for ");
-    PRINT6ADDR(nexthop);
-    PRINTF("\n");
-    return NULL;
-  }
-
   /* First make sure that we don't add a route twice. If we find an
      existing route for our destination, we'll delete the old
      one first. */
@@ -355,7 +458,7 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 #if UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
       /* Removing the oldest route entry from the route table. The
          least recently used route is the first route on the list. */
-      oldest = list_tail(routelist);
+      oldest = tlist_tail(routelist);
 #endif
       if(oldest == NULL) {
         return NULL;
@@ -411,7 +514,7 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
     /* add new routes first - assuming that there is a reason to add this
        and that there is a packet coming soon. */
-    list_push(routelist, r);
+    tlist_push(routelist, r);
 
     nbrr = memb_alloc(&neighborroutememb);
     if(nbrr == NULL) {
@@ -436,6 +539,9 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
+#if UIP_DS6_ROUTE_WITH_INDEX
+  index_add(r);
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
 
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
@@ -456,11 +562,63 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
   assert_nbr_routes_list_sane();
 #endif /* DEBUG != DEBUG_NONE */
   return r;
-
+}
+#endif /* (UIP_CONF_MAX_ROUTES != 0) */
+/*---------------------------------------------------------------------------*/
+uip_ds6_route_t *
+uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
+		  uip_ipaddr_t *nexthop)
+{
+#if (UIP_CONF_MAX_ROUTES != 0)
+  /* Get link-layer address of next hop, make sure it is in neighbor table */
+  const uip_lladdr_t *nexthop_lladdr = uip_ds6_nbr_lladdr_from_ipaddr(nexthop);
+  if(nexthop_lladdr == NULL) {
+    PRINTF("uip_ds6_route_add: neighbor link-local address unknown for ");
+    PRINT6ADDR(nexthop);
+    PRINTF("\n");
+    return NULL;
+  }
+  return add_route(ipaddr, length, nexthop, nexthop_lladdr);
 #else /* (UIP_CONF_MAX_ROUTES != 0) */
   return NULL;
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
 }
+/*---------------------------------------------------------------------------*/
+int
+uip_ds6_route_add_bulk(uip_ds6_route_prefix_t *prefixes, int count,
+                       uip_ipaddr_t *nexthop)
+{
+#if (UIP_CONF_MAX_ROUTES != 0)
+  const uip_lladdr_t *nexthop_lladdr;
+  int i, added;
+
+  for(i = 0; i < count; i++) {
+    prefixes[i].route = NULL;
+  }
+  if(count > UIP_DS6_ROUTE_NB) {
+    count = UIP_DS6_ROUTE_NB;
+  }
+
+  /* The next hop is resolved once for the whole batch */
+  nexthop_lladdr = uip_ds6_nbr_lladdr_from_ipaddr(nexthop);
+  if(nexthop_lladdr == NULL) {
+    PRINTF("uip_ds6_route_add_bulk: neighbor link-local address unknown for ");
+    PRINT6ADDR(nexthop);
+    PRINTF("\n");
+    return 0;
+  }
+  for(i = added = 0; i < count; i++) {
+    prefixes[i].route = add_route(&prefixes[i].ipaddr, prefixes[i].length,
+                                  nexthop, nexthop_lladdr);
+    if(prefixes[i].route != NULL) {
+      added++;
+    }
+  }
+  return added;
+#else /* (UIP_CONF_MAX_ROUTES != 0) */
+  return 0;
+#endif /* (UIP_CONF_MAX_ROUTES != 0) */
+}
 
 /*---------------------------------------------------------------------------*/
 void
@@ -478,7 +636,10 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
     PRINTF("\n");
 
     /* Remove the route from the route list */
-    list_remove(routelist, route);
+    tlist_remove(routelist, route);
+#if UIP_DS6_ROUTE_WITH_INDEX
+    index_rm(route);
+#endif /* UIP_DS6_ROUTE_WITH_INDEX */
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
@@ -88,6 +88,21 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_CONF_MAX_ROUTES */
 
+/* Longest prefix match index for route lookups. Small tables are
+   scanned instead, which saves the RAM of the index. */
+#ifdef UIP_DS6_ROUTE_CONF_WITH_INDEX
+#define UIP_DS6_ROUTE_WITH_INDEX UIP_DS6_ROUTE_CONF_WITH_INDEX
+#else /* UIP_DS6_ROUTE_CONF_WITH_INDEX */
+#define UIP_DS6_ROUTE_WITH_INDEX (UIP_DS6_ROUTE_NB > 16)
+#endif /* UIP_DS6_ROUTE_CONF_WITH_INDEX */
+
+/* Number of hash buckets of the index, one per route by default */
+#ifdef UIP_DS6_ROUTE_CONF_HASH_SIZE
+#define UIP_DS6_ROUTE_HASH_SIZE UIP_DS6_ROUTE_CONF_HASH_SIZE
+#else /* UIP_DS6_ROUTE_CONF_HASH_SIZE */
+#define UIP_DS6_ROUTE_HASH_SIZE UIP_DS6_ROUTE_NB
+#endif /* UIP_DS6_ROUTE_CONF_HASH_SIZE */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -146,7 +161,9 @@ struct uip_ds6_route_neighbor_routes {
 
 /** \brief An entry in the routing table */
 typedef struct uip_ds6_route {
+  /* next and prev link the route list, they must be the first fields */
   struct uip_ds6_route *next;
+  struct uip_ds6_route *prev;
   /* Each route entry belongs to a specific neighbor. That neighbor
      holds a list of all routing entries that go through it. The
      routes field point to the uip_ds6_route_neighbor_routes that
@@ -167,6 +184,14 @@ struct uip_ds6_route_neighbor_route {
   struct uip_ds6_route *route;
 };
 
+/** \brief A destination prefix, used by uip_ds6_route_add_bulk() */
+typedef struct uip_ds6_route_prefix {
+  uip_ipaddr_t ipaddr;
+  uint8_t length;
+  /* Set by uip_ds6_route_add_bulk(), NULL if the route was not added */
+  uip_ds6_route_t *route;
+} uip_ds6_route_prefix_t;
+
 /** \brief An entry in the default router list */
 typedef struct uip_ds6_defrt {
   struct uip_ds6_defrt *next;
@@ -193,6 +218,12 @@ void uip_ds6_defrt_periodic(void);
 uip_ds6_route_t *uip_ds6_route_lookup(uip_ipaddr_t *destipaddr);
 uip_ds6_route_t *uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
                                    uip_ipaddr_t *next_hop);
+/* Adds routes to many prefixes through one next hop, e.g. the targets
+   of a DAO, and returns the number of routes added. The next hop
+   neighbor is resolved once for the batch. At most UIP_DS6_ROUTE_NB
+   prefixes are added, so the batch never evicts its own routes. */
+int uip_ds6_route_add_bulk(uip_ds6_route_prefix_t *prefixes, int count,
+                           uip_ipaddr_t *next_hop);
 void uip_ds6_route_rm(uip_ds6_route_t *route);
 void uip_ds6_route_rm_by_nexthop(uip_ipaddr_t *nexthop);
 
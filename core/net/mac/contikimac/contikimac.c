@@ -1042,6 +1042,7 @@ init(void)
   radio_is_on = 0;
   PT_INIT(&pt);
 
+  rtimer_set_priority(&rt, RTIMER_PRIORITY_HIGH);
   rtimer_set(&rt, RTIMER_NOW() + CYCLE_TIME, 1, powercycle_wrapper, NULL);
 
   contikimac_is_on = 1;
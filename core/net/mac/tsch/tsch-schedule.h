@@ -37,6 +37,7 @@
 
 #include "contiki.h"
 #include "lib/list.h"
+#include "lib/tlist.h"
 #include "net/mac/tsch/tsch-private.h"
 #include "net/mac/tsch/tsch-queue.h"
 #include "net/mac/tsch/tsch-slot-operation.h"
@@ -87,8 +88,10 @@
 enum link_type { LINK_TYPE_NORMAL, LINK_TYPE_ADVERTISING, LINK_TYPE_ADVERTISING_ONLY };
 
 struct tsch_link {
-  /* Links are stored as a list: "next" must be the first field */
+  /* Links are stored as a doubly linked list: "next" and "prev" must be
+   * the first fields */
   struct tsch_link *next;
+  struct tsch_link *prev;
   /* Unique identifier */
   uint16_t handle;
   /* MAC address of neighbor */
@@ -121,7 +124,7 @@ struct tsch_slotframe {
    * Stored as struct asn_divisor_t because we often need ASN%size */
   struct tsch_asn_divisor_t size;
   /* List of links belonging to this slotframe */
-  LIST_STRUCT(links_list);
+  TLIST_STRUCT(links_list);
 };
 
 /********** Functions *********/
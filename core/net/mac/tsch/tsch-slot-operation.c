@@ -1060,6 +1060,7 @@ tsch_slot_operation_start(void)
   rtimer_clock_t time_to_next_active_slot;
   rtimer_clock_t prev_slot_start;
   TSCH_DEBUG_INIT();
+  rtimer_set_priority(&slot_operation_timer, RTIMER_PRIORITY_HIGH);
   do {
     uint16_t timeslot_diff;
     /* Get next active link */
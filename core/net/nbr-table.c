@@ -83,6 +83,19 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_WITH_HASH
+/* Hash index over the keys: chains of neighbor indexes per bucket,
+ * stored as index + 1 so that 0 ends a chain. The list above keeps the
+ * insertion order used for replacement. */
+#if NBR_TABLE_MAX_NEIGHBORS < 255
+typedef uint8_t nbr_hash_index_t;
+#else
+typedef uint16_t nbr_hash_index_t;
+#endif
+static nbr_hash_index_t hash_buckets[NBR_TABLE_HASH_SIZE];
+static nbr_hash_index_t hash_next[NBR_TABLE_MAX_NEIGHBORS];
+#endif /* NBR_TABLE_WITH_HASH */
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -126,16 +139,71 @@ key_from_item(nbr_table_t *table, const nbr_table_item_t *item)
   return key_from_index(index_from_item(table, item));
 }
 /*---------------------------------------------------------------------------*/
+#if NBR_TABLE_WITH_HASH
+static unsigned
+hash_lladdr(const linkaddr_t *lladdr)
+{
+  uint16_t h = 0;
+  int i;
+
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    h = (h << 5) + h + lladdr->u8[i];
+  }
+  return h % NBR_TABLE_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+/* Index a key under its current link-layer address */
+static void
+hash_add(nbr_table_key_t *key)
+{
+  unsigned bucket = hash_lladdr(&key->lladdr);
+  int index = index_from_key(key);
+
+  hash_next[index] = hash_buckets[bucket];
+  hash_buckets[bucket] = index + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Unlink a key, must be called before its link-layer address changes */
+static void
+hash_remove(nbr_table_key_t *key)
+{
+  nbr_hash_index_t *p = &hash_buckets[hash_lladdr(&key->lladdr)];
+  int index = index_from_key(key);
+
+  while(*p != 0) {
+    if(*p == index + 1) {
+      *p = hash_next[index];
+      return;
+    }
+    p = &hash_next[*p - 1];
+  }
+}
+#endif /* NBR_TABLE_WITH_HASH */
+/*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const linkaddr_t *lladdr)
 {
   nbr_table_key_t *key;
+#if NBR_TABLE_WITH_HASH
+  nbr_hash_index_t index;
+#endif /* NBR_TABLE_WITH_HASH */
+
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by linkaddr_null. */
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_WITH_HASH
+  for(index = hash_buckets[hash_lladdr(lladdr)]; index != 0;
+      index = hash_next[index - 1]) {
+    key = key_from_index(index - 1);
+    if(linkaddr_cmp(lladdr, &key->lladdr)) {
+      return index - 1;
+    }
+  }
+  return -1;
+#else /* NBR_TABLE_WITH_HASH */
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
@@ -144,6 +212,7 @@ index_from_lladdr(const linkaddr_t *lladdr)
     key = list_item_next(key);
   }
   return -1;
+#endif /* NBR_TABLE_WITH_HASH */
 }
 /*---------------------------------------------------------------------------*/
 /* Get bit from "used" or "locked" bitmap */
@@ -195,6 +264,9 @@ remove_key(nbr_table_key_t *least_used_key)
   used_map[index_from_key(least_used_key)] = 0;
   /* Remove neighbor from list */
   list_remove(nbr_table_keys, least_used_key);
+#if NBR_TABLE_WITH_HASH
+  hash_remove(least_used_key);
+#endif /* NBR_TABLE_WITH_HASH */
 }
 /*---------------------------------------------------------------------------*/
 static nbr_table_key_t *
@@ -359,6 +431,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr, nbr_table_rea
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_WITH_HASH
+    hash_add(key);
+#endif /* NBR_TABLE_WITH_HASH */
   }
 
   /* Get item in the current table */
@@ -446,11 +521,17 @@ nbr_table_update_lladdr(const linkaddr_t *old_addr, const linkaddr_t *new_addr,
     return 0;
   }
   key = key_from_index(index);
+#if NBR_TABLE_WITH_HASH
+  hash_remove(key);
+#endif /* NBR_TABLE_WITH_HASH */
   /**
    * Copy the new lladdr into the key - since we know that there is no
    * conflicting entry.
    */
   memcpy(&key->lladdr, new_addr, sizeof(linkaddr_t));
+#if NBR_TABLE_WITH_HASH
+  hash_add(key);
+#endif /* NBR_TABLE_WITH_HASH */
   return 1;
 }
 /*---------------------------------------------------------------------------*/
@@ -167,6 +167,17 @@
   #define RPL_DAO_SPECIFY_DAG RPL_CONF_DAO_SPECIFY_DAG
 #endif /* RPL_CONF_DAO_SPECIFY_DAG */
 
+/*
+ * Maximum number of target options of a DAO that are installed as
+ * routes in storing mode. The routes of one DAO are added as a batch
+ * through the same next hop.
+ */
+#ifdef RPL_CONF_DAO_MAX_TARGETS
+#define RPL_DAO_MAX_TARGETS RPL_CONF_DAO_MAX_TARGETS
+#else
+#define RPL_DAO_MAX_TARGETS 4
+#endif /* RPL_CONF_DAO_MAX_TARGETS */
+
 /*
  * The DIO interval (n) represents 2^n ms.
  *
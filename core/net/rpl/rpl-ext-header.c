@@ -322,6 +322,28 @@ count_matching_bytes(const void *p1, const void *p2, size_t n)
   return n;
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_NS_SRH_CACHE_SIZE
+/* Source routes computed earlier, direct-mapped by destination node. An
+ * entry is valid as long as the topology version it was built at is
+ * current, i.e. no node got a new parent and no node was removed. */
+struct srh_cache_entry {
+  const rpl_ns_node_t *dest;
+  const rpl_ns_node_t *first_hop;
+  uint32_t version;
+  uint8_t path_len;
+  uint8_t cmpr;
+  uint8_t addr_len;
+  uint8_t addrs[RPL_NS_SRH_CACHE_ENTRY_LEN];
+};
+static struct srh_cache_entry srh_cache[RPL_NS_SRH_CACHE_SIZE];
+
+static struct srh_cache_entry *
+srh_cache_slot(const rpl_ns_node_t *dest)
+{
+  return &srh_cache[((uintptr_t)dest / sizeof(rpl_ns_node_t)) % RPL_NS_SRH_CACHE_SIZE];
+}
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+/*---------------------------------------------------------------------------*/
 static int
 insert_srh_header(void)
 {
@@ -337,6 +359,10 @@ insert_srh_header(void)
   rpl_ns_node_t *node;
   rpl_dag_t *dag;
   uip_ipaddr_t node_addr;
+#if RPL_NS_SRH_CACHE_SIZE
+  struct srh_cache_entry *entry;
+  int cached;
+#endif /* RPL_NS_SRH_CACHE_SIZE */
 
   PRINTF("RPL: SRH creating source routing header with destination ");
   PRINT6ADDR(&UIP_IP_BUF->destipaddr);
@@ -364,6 +390,17 @@ insert_srh_header(void)
     return 0;
   }
 
+#if RPL_NS_SRH_CACHE_SIZE
+  entry = srh_cache_slot(dest_node);
+  cached = entry->dest == dest_node && entry->version == rpl_ns_topology_version();
+  if(cached) {
+    path_len = entry->path_len;
+    cmpri = entry->cmpr;
+    cmpre = cmpri;
+    PRINTF("RPL: SRH from cache\n");
+  } else {
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+
   if(!rpl_ns_is_node_reachable(dag, &UIP_IP_BUF->destipaddr)) {
     PRINTF("RPL: SRH no path found to destination\n");
     return 0;
@@ -396,6 +433,10 @@ insert_srh_header(void)
     path_len++;
   }
 
+#if RPL_NS_SRH_CACHE_SIZE
+  }
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+
   /* Extension header length: fixed headers + (n-1) * (16-ComprI) + (16-ComprE)*/
   ext_len = RPL_RH_LEN + RPL_SRH_LEN
       + (path_len - 1) * (16 - cmpre)
@@ -436,6 +477,13 @@ insert_srh_header(void)
   node = dest_node;
   hop_ptr = ((uint8_t *)UIP_RH_BUF) + ext_len - padding; /* Pointer where to write the next hop compressed address */
 
+#if RPL_NS_SRH_CACHE_SIZE
+  if(cached) {
+    memcpy(hop_ptr - entry->addr_len, entry->addrs, entry->addr_len);
+    node = (rpl_ns_node_t *)entry->first_hop;
+  } else {
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+
   while(node != NULL && node->parent != root_node) {
     rpl_ns_get_node_global_addr(&node_addr, node);
 
@@ -445,6 +493,22 @@ insert_srh_header(void)
     node = node->parent;
   }
 
+#if RPL_NS_SRH_CACHE_SIZE
+  /* Keep the route for the next packets to this destination */
+  if(path_len * (16 - cmpri) <= RPL_NS_SRH_CACHE_ENTRY_LEN) {
+    entry->dest = dest_node;
+    entry->first_hop = node;
+    entry->version = rpl_ns_topology_version();
+    entry->path_len = path_len;
+    entry->cmpr = cmpri;
+    entry->addr_len = path_len * (16 - cmpri);
+    memcpy(entry->addrs, hop_ptr, entry->addr_len);
+  } else {
+    entry->dest = NULL;
+  }
+  }
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+
   /* The next hop (i.e. node whose parent is the root) is placed as the current IPv6 destination */
   rpl_ns_get_node_global_addr(&node_addr, node);
   uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &node_addr);
@@ -640,6 +640,8 @@ dao_input_storing(void)
   uint8_t pathsequence;
   */
   uip_ipaddr_t prefix;
+  uip_ds6_route_prefix_t targets[RPL_DAO_MAX_TARGETS];
+  int target_count;
   uip_ds6_route_t *rep;
   uint8_t buffer_length;
   int pos;
@@ -651,6 +653,7 @@ dao_input_storing(void)
   int is_root;
 
   prefixlen = 0;
+  target_count = 0;
   parent = NULL;
 
   uip_ipaddr_copy(&dao_sender_addr, &UIP_IP_BUF->srcipaddr);
@@ -730,6 +733,14 @@ dao_input_storing(void)
       prefixlen = buffer[i + 3];
       memset(&prefix, 0, sizeof(prefix));
       memcpy(&prefix, buffer + i + 4, (prefixlen + 7) / CHAR_BIT);
+      if(target_count < RPL_DAO_MAX_TARGETS) {
+        uip_ipaddr_copy(&targets[target_count].ipaddr, &prefix);
+        targets[target_count].length = prefixlen;
+        target_count++;
+      } else {
+        PRINTF("RPL: Ignoring DAO target beyond %d targets\n",
+               RPL_DAO_MAX_TARGETS);
+      }
       break;
     case RPL_OPTION_TRANSIT:
       /* The path sequence and control are ignored. */
@@ -819,7 +830,11 @@ dao_input_storing(void)
     return;
   }
 
-  rep = rpl_add_route(dag, &prefix, prefixlen, &dao_sender_addr);
+  /* All targets of the DAO go through the sender, so the sender is
+     resolved once for the whole batch. The last target drives the
+     DAO forwarding and acknowledgement below. */
+  rpl_add_routes(dag, targets, target_count, &dao_sender_addr);
+  rep = target_count > 0 ? targets[target_count - 1].route : NULL;
   if(rep == NULL) {
     RPL_STAT(rpl_stats.mem_overflows++);
     PRINTF("RPL: Could not add a route after receiving a DAO\n");
@@ -832,9 +847,12 @@ dao_input_storing(void)
     return;
   }
 
-  /* set lifetime and clear NOPATH bit */
-  rep->state.lifetime = RPL_LIFETIME(instance, lifetime);
-  RPL_ROUTE_CLEAR_NOPATH_RECEIVED(rep);
+  /* set lifetime, the NOPATH bit is cleared by rpl_add_routes() */
+  for(i = 0; i < target_count; i++) {
+    if(targets[i].route != NULL) {
+      targets[i].route->state.lifetime = RPL_LIFETIME(instance, lifetime);
+    }
+  }
 
 #if RPL_WITH_MULTICAST
 fwd_dao:
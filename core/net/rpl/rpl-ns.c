@@ -63,6 +63,21 @@ static int num_nodes;
 LIST(nodelist);
 MEMB(nodememb, rpl_ns_node_t, RPL_NS_LINK_NUM);
 
+/* Bumped on every change of the tree, see rpl_ns_topology_version() */
+static uint32_t topology_version;
+
+#if RPL_NS_WITH_HASH
+/* Hash index over the link identifiers: chains of node indexes per
+ * bucket, stored as index + 1 so that 0 ends a chain */
+#if RPL_NS_LINK_NUM < 255
+typedef uint8_t rpl_ns_hash_index_t;
+#else
+typedef uint16_t rpl_ns_hash_index_t;
+#endif
+static rpl_ns_hash_index_t hash_buckets[RPL_NS_HASH_SIZE];
+static rpl_ns_hash_index_t hash_next[RPL_NS_LINK_NUM];
+#endif /* RPL_NS_WITH_HASH */
+
 /*---------------------------------------------------------------------------*/
 int
 rpl_ns_num_nodes(void)
@@ -70,6 +85,57 @@ rpl_ns_num_nodes(void)
   return num_nodes;
 }
 /*---------------------------------------------------------------------------*/
+uint32_t
+rpl_ns_topology_version(void)
+{
+  return topology_version;
+}
+/*---------------------------------------------------------------------------*/
+#if RPL_NS_WITH_HASH
+static unsigned
+hash_link_identifier(const unsigned char *link_identifier)
+{
+  uint16_t h = 0;
+  int i;
+
+  for(i = 0; i < 8; i++) {
+    h = (h << 5) + h + link_identifier[i];
+  }
+  return h % RPL_NS_HASH_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static int
+node_index(const rpl_ns_node_t *node)
+{
+  return node - (rpl_ns_node_t *)nodememb.mem;
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_add(rpl_ns_node_t *node)
+{
+  unsigned bucket = hash_link_identifier(node->link_identifier);
+  int index = node_index(node);
+
+  hash_next[index] = hash_buckets[bucket];
+  hash_buckets[bucket] = index + 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_remove(rpl_ns_node_t *node)
+{
+  rpl_ns_hash_index_t *p = &hash_buckets[hash_link_identifier(node->link_identifier)];
+  int index = node_index(node);
+
+  while(*p != 0) {
+    if(*p == index + 1) {
+      *p = hash_next[index];
+      return;
+    }
+    p = &hash_next[*p - 1];
+  }
+}
+#endif /* RPL_NS_WITH_HASH */
+/*---------------------------------------------------------------------------*/
 static int
 node_matches_address(const rpl_dag_t *dag, const rpl_ns_node_t *node, const uip_ipaddr_t *addr)
 {
@@ -85,12 +151,27 @@ rpl_ns_node_t *
 rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr)
 {
   rpl_ns_node_t *l;
+#if RPL_NS_WITH_HASH
+  rpl_ns_hash_index_t index;
+
+  if(addr == NULL) {
+    return NULL;
+  }
+  for(index = hash_buckets[hash_link_identifier(((const unsigned char *)addr) + 8)];
+      index != 0; index = hash_next[index - 1]) {
+    l = (rpl_ns_node_t *)nodememb.mem + index - 1;
+    if(node_matches_address(dag, l, addr)) {
+      return l;
+    }
+  }
+#else /* RPL_NS_WITH_HASH */
   for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
     /* Compare prefix and node identifier */
     if(node_matches_address(dag, l, addr)) {
       return l;
     }
   }
+#endif /* RPL_NS_WITH_HASH */
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
@@ -123,6 +204,9 @@ rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr_t
   rpl_ns_node_t *child_node = rpl_ns_get_node(dag, child);
   rpl_ns_node_t *parent_node = rpl_ns_get_node(dag, parent);
   rpl_ns_node_t *old_parent_node;
+  rpl_ns_node_t *prev_parent_node;
+  rpl_dag_t *prev_dag;
+  int is_new = 0;
 
   if(parent != NULL) {
     /* No node for the parent, add one with infinite lifetime */
@@ -142,14 +226,23 @@ rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr_t
       return NULL;
     }
     child_node->parent = NULL;
+    child_node->dag = NULL;
     list_add(nodelist, child_node);
     num_nodes++;
+    is_new = 1;
   }
+  prev_parent_node = child_node->parent;
+  prev_dag = child_node->dag;
 
   /* Initialize node */
   child_node->dag = dag;
   child_node->lifetime = lifetime;
   memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
+#if RPL_NS_WITH_HASH
+  if(is_new) {
+    hash_add(child_node);
+  }
+#endif /* RPL_NS_WITH_HASH */
 
   /* Is the node reachable before the update? */
   if(rpl_ns_is_node_reachable(dag, child)) {
@@ -167,6 +260,10 @@ rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr_t
     child_node->parent = parent_node;
   }
 
+  if(is_new || child_node->parent != prev_parent_node || child_node->dag != prev_dag) {
+    topology_version++;
+  }
+
   return child_node;
 }
 /*---------------------------------------------------------------------------*/
@@ -176,6 +273,10 @@ rpl_ns_init(void)
   num_nodes = 0;
   memb_init(&nodememb);
   list_init(nodelist);
+#if RPL_NS_WITH_HASH
+  memset(hash_buckets, 0, sizeof(hash_buckets));
+#endif /* RPL_NS_WITH_HASH */
+  topology_version++;
 }
 /*---------------------------------------------------------------------------*/
 rpl_ns_node_t *
@@ -220,6 +321,10 @@ rpl_ns_periodic(void)
         }
       }
       /* No child found, deallocate node */
+#if RPL_NS_WITH_HASH
+      hash_remove(l);
+#endif /* RPL_NS_WITH_HASH */
+      topology_version++;
       list_remove(nodelist, l);
       memb_free(&nodememb, l);
       num_nodes--;
@@ -49,6 +49,37 @@
 #define RPL_NS_LINK_NUM 32
 #endif /* RPL_NS_CONF_LINK_NUM */
 
+/* Hash index for node lookups by address. Small tables are scanned
+ * instead, which saves the RAM of the index. */
+#ifdef RPL_NS_CONF_WITH_HASH
+#define RPL_NS_WITH_HASH RPL_NS_CONF_WITH_HASH
+#else /* RPL_NS_CONF_WITH_HASH */
+#define RPL_NS_WITH_HASH (RPL_NS_LINK_NUM > 16)
+#endif /* RPL_NS_CONF_WITH_HASH */
+
+/* Number of hash buckets, one per node by default */
+#ifdef RPL_NS_CONF_HASH_SIZE
+#define RPL_NS_HASH_SIZE RPL_NS_CONF_HASH_SIZE
+#else /* RPL_NS_CONF_HASH_SIZE */
+#define RPL_NS_HASH_SIZE RPL_NS_LINK_NUM
+#endif /* RPL_NS_CONF_HASH_SIZE */
+
+/* Number of source routing headers cached by the root, one per
+ * destination. 0 builds the header from the node table every time. */
+#ifdef RPL_NS_CONF_SRH_CACHE_SIZE
+#define RPL_NS_SRH_CACHE_SIZE RPL_NS_CONF_SRH_CACHE_SIZE
+#else /* RPL_NS_CONF_SRH_CACHE_SIZE */
+#define RPL_NS_SRH_CACHE_SIZE (RPL_NS_LINK_NUM > 16 ? 32 : 0)
+#endif /* RPL_NS_CONF_SRH_CACHE_SIZE */
+
+/* Room for compressed addresses in a cache entry, longer source
+ * routes are not cached */
+#ifdef RPL_NS_CONF_SRH_CACHE_ENTRY_LEN
+#define RPL_NS_SRH_CACHE_ENTRY_LEN RPL_NS_CONF_SRH_CACHE_ENTRY_LEN
+#else /* RPL_NS_CONF_SRH_CACHE_ENTRY_LEN */
+#define RPL_NS_SRH_CACHE_ENTRY_LEN 64
+#endif /* RPL_NS_CONF_SRH_CACHE_ENTRY_LEN */
+
 typedef struct rpl_ns_node {
   struct rpl_ns_node *next;
   uint32_t lifetime;
@@ -68,5 +99,8 @@ rpl_ns_node_t *rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr);
 int rpl_ns_is_node_reachable(const rpl_dag_t *dag, const uip_ipaddr_t *addr);
 void rpl_ns_get_node_global_addr(uip_ipaddr_t *addr, rpl_ns_node_t *node);
 void rpl_ns_periodic(void);
+/* Changes whenever a node gets a new parent or a node is removed, i.e.
+ * whenever a source route computed earlier may no longer be valid */
+uint32_t rpl_ns_topology_version(void);
 
 #endif /* RPL_NS_H */
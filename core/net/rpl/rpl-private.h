@@ -384,6 +384,8 @@ void rpl_remove_routes(rpl_dag_t *dag);
 void rpl_remove_routes_by_nexthop(uip_ipaddr_t *nexthop, rpl_dag_t *dag);
 uip_ds6_route_t *rpl_add_route(rpl_dag_t *dag, uip_ipaddr_t *prefix,
                                int prefix_len, uip_ipaddr_t *next_hop);
+int rpl_add_routes(rpl_dag_t *dag, uip_ds6_route_prefix_t *prefixes,
+                   int count, uip_ipaddr_t *next_hop);
 void rpl_purge_routes(void);
 
 /* Objective function. */
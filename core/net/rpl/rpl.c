@@ -249,6 +249,38 @@ rpl_add_route(rpl_dag_t *dag, uip_ipaddr_t *prefix, int prefix_len,
   return rep;
 }
 /*---------------------------------------------------------------------------*/
+int
+rpl_add_routes(rpl_dag_t *dag, uip_ds6_route_prefix_t *prefixes, int count,
+               uip_ipaddr_t *next_hop)
+{
+  uip_ds6_route_t *rep;
+  int added;
+  int i;
+
+  added = uip_ds6_route_add_bulk(prefixes, count, next_hop);
+  if(added < count) {
+    PRINTF("RPL: No space for %d of %d route entries\n", count - added, count);
+  }
+
+  for(i = 0; i < count; i++) {
+    rep = prefixes[i].route;
+    if(rep == NULL) {
+      continue;
+    }
+    rep->state.dag = dag;
+    rep->state.lifetime = RPL_LIFETIME(dag->instance, dag->instance->default_lifetime);
+    RPL_ROUTE_CLEAR_NOPATH_RECEIVED(rep);
+
+    PRINTF("RPL: Added a route to ");
+    PRINT6ADDR(&prefixes[i].ipaddr);
+    PRINTF("/%d via ", prefixes[i].length);
+    PRINT6ADDR(next_hop);
+    PRINTF("\n");
+  }
+
+  return added;
+}
+/*---------------------------------------------------------------------------*/
 void
 rpl_link_neighbor_callback(const linkaddr_t *addr, int status, int numtx)
 {
@@ -39,5 +39,16 @@
 
 #define CC_CONF_ALIGN(n) __attribute__((__aligned__(n)))
 
+#ifndef CC_CONF_MEMORY_BARRIER
+#if defined(__aarch64__)
+#define CC_CONF_MEMORY_BARRIER() __asm__ __volatile__ ("dmb ish" ::: "memory")
+#elif defined(__ARM_ARCH) && (__ARM_ARCH >= 7 || defined(__ARM_ARCH_6M__))
+#define CC_CONF_MEMORY_BARRIER() __asm__ __volatile__ ("dmb" ::: "memory")
+#else
+/* In-order single core CPUs and x86 only need the compiler barrier */
+#define CC_CONF_MEMORY_BARRIER() __asm__ __volatile__ ("" ::: "memory")
+#endif
+#endif /* CC_CONF_MEMORY_BARRIER */
+
 #endif /* __GNUC__ */
 #endif /* _CC_GCC_H_ */
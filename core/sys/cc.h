@@ -129,6 +129,19 @@
 
 #define CC_ACCESS_NOW(type, variable) (*(volatile type *)&(variable))
 
+/** \def CC_MEMORY_BARRIER()
+ * This macro orders memory accesses before it against memory accesses
+ * after it, both for the compiler and for the CPU. It is needed where
+ * one side, e.g. an interrupt handler, DMA or another core, publishes
+ * data by writing an index the other side reads, as in the ring
+ * buffer libraries.
+ */
+#ifdef CC_CONF_MEMORY_BARRIER
+#define CC_MEMORY_BARRIER() CC_CONF_MEMORY_BARRIER()
+#else
+#define CC_MEMORY_BARRIER()
+#endif /* CC_CONF_MEMORY_BARRIER */
+
 #ifndef NULL
 #define NULL 0
 #endif /* NULL */
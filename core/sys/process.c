@@ -44,9 +44,14 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "sys/process.h"
 #include "sys/arg.h"
+#if PROCESS_ACCOUNTING
+#include "sys/clock.h"
+#include "sys/rtimer.h"
+#endif /* PROCESS_ACCOUNTING */
 
 /*
  * Pointer to the currently running process structure.
@@ -63,21 +68,47 @@ struct event_data {
   process_event_t ev;
   process_data_t data;
   struct process *p;
+#if PROCESS_QUOTA
+  struct process *from;
+#endif /* PROCESS_QUOTA */
 };
 
+/*
+ * The event queue. With PROCESS_PRIORITIES high priority events have
+ * their own ring and are delivered first.
+ */
 static process_num_events_t nevents, fevent;
 static struct event_data events[PROCESS_CONF_NUMEVENTS];
+#if PROCESS_PRIORITIES
+static process_num_events_t nevents_high, fevent_high;
+static struct event_data events_high[PROCESS_CONF_NUMEVENTS_HIGH];
+#define QUEUED_EVENTS() (nevents + nevents_high)
+#else /* PROCESS_PRIORITIES */
+#define QUEUED_EVENTS() nevents
+#endif /* PROCESS_PRIORITIES */
 
 #if PROCESS_CONF_STATS
 process_num_events_t process_maxevents;
+#if PROCESS_PRIORITIES
+process_num_events_t process_maxevents_high;
+#endif /* PROCESS_PRIORITIES */
+static unsigned short drops[PROCESS_STATS_EVENTS];
 #endif
 
 static volatile unsigned char poll_requested;
 
+#if PROCESS_ACCOUNTING
+/* Run time of processes called synchronously from the running one */
+static uint32_t nested_time;
+#endif /* PROCESS_ACCOUNTING */
+
 #define PROCESS_STATE_NONE        0
 #define PROCESS_STATE_RUNNING     1
 #define PROCESS_STATE_CALLED      2
 
+/* High priority event queued in the normal queue, see process_post_prio() */
+#define PROCESS_PRIO_DEMOTED      2
+
 static void call_process(struct process *p, process_event_t ev, process_data_t data);
 
 #define DEBUG 0
@@ -187,7 +218,27 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
     PRINTF("process: calling process '%s' with event %d\n", PROCESS_NAME_STRING(p), ev);
     process_current = p;
     p->state = PROCESS_STATE_CALLED;
+#if PROCESS_ACCOUNTING
+    {
+      uint32_t outer = nested_time;
+      rtimer_clock_t start = RTIMER_NOW();
+      uint32_t elapsed, self;
+
+      nested_time = 0;
+      ret = p->thread(&p->pt, ev, data);
+      elapsed = (rtimer_clock_t)(RTIMER_NOW() - start);
+      self = elapsed > nested_time ? elapsed - nested_time : 0;
+      nested_time = outer + elapsed;
+
+      p->accounting.calls++;
+      p->accounting.time += self;
+      if(self > p->accounting.max) {
+        p->accounting.max = self;
+      }
+    }
+#else
     ret = p->thread(&p->pt, ev, data);
+#endif /* PROCESS_ACCOUNTING */
     if(ret == PT_EXITED ||
        ret == PT_ENDED ||
        ev == PROCESS_EVENT_EXIT) {
@@ -210,8 +261,15 @@ process_init(void)
   lastevent = PROCESS_EVENT_MAX;
 
   nevents = fevent = 0;
+#if PROCESS_PRIORITIES
+  nevents_high = fevent_high = 0;
+#endif /* PROCESS_PRIORITIES */
 #if PROCESS_CONF_STATS
   process_maxevents = 0;
+#if PROCESS_PRIORITIES
+  process_maxevents_high = 0;
+#endif /* PROCESS_PRIORITIES */
+  memset(drops, 0, sizeof(drops));
 #endif /* PROCESS_CONF_STATS */
 
   process_current = process_list = NULL;
@@ -258,6 +316,15 @@ do_event(void)
    * call the poll handlers inbetween.
    */
 
+#if PROCESS_PRIORITIES
+  if(nevents_high > 0) {
+    ev = events_high[fevent_high].ev;
+    data = events_high[fevent_high].data;
+    receiver = events_high[fevent_high].p;
+    fevent_high = (fevent_high + 1) % PROCESS_CONF_NUMEVENTS_HIGH;
+    --nevents_high;
+  } else
+#endif /* PROCESS_PRIORITIES */
   if(nevents > 0) {
     
     /* There are events that we should deliver. */
@@ -265,36 +332,49 @@ do_event(void)
     
     data = events[fevent].data;
     receiver = events[fevent].p;
+#if PROCESS_QUOTA
+    if(events[fevent].from != NULL) {
+      events[fevent].from->nposted--;
+    }
+#endif /* PROCESS_QUOTA */
 
     /* Since we have seen the new event, we move pointer upwards
        and decrease the number of events. */
     fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
     --nevents;
+  } else {
+    return;
+  }
 
-    /* If this is a broadcast event, we deliver it to all events, in
-       order of their priority. */
-    if(receiver == PROCESS_BROADCAST) {
-      for(p = process_list; p != NULL; p = p->next) {
-
-	/* If we have been requested to poll a process, we do this in
-	   between processing the broadcast event. */
-	if(poll_requested) {
-	  do_poll();
-	}
-	call_process(p, ev, data);
-      }
-    } else {
-      /* This is not a broadcast event, so we deliver it to the
-	 specified process. */
-      /* If the event was an INIT event, we should also update the
-	 state of the process. */
-      if(ev == PROCESS_EVENT_INIT) {
-	receiver->state = PROCESS_STATE_RUNNING;
-      }
+  /* If this is a broadcast event, we deliver it to all events, in
+     order of their priority. */
+  if(receiver == PROCESS_BROADCAST) {
+    for(p = process_list; p != NULL; p = p->next) {
 
-      /* Make sure that the process actually is running. */
-      call_process(receiver, ev, data);
+      /* If we have been requested to poll a process, we do this in
+         between processing the broadcast event. */
+      if(poll_requested) {
+        do_poll();
+      }
+#if PROCESS_ACCOUNTING
+      p->accounting.events++;
+#endif /* PROCESS_ACCOUNTING */
+      call_process(p, ev, data);
+    }
+  } else {
+    /* This is not a broadcast event, so we deliver it to the
+       specified process. */
+    /* If the event was an INIT event, we should also update the
+       state of the process. */
+    if(ev == PROCESS_EVENT_INIT) {
+      receiver->state = PROCESS_STATE_RUNNING;
     }
+
+#if PROCESS_ACCOUNTING
+    receiver->accounting.events++;
+#endif /* PROCESS_ACCOUNTING */
+    /* Make sure that the process actually is running. */
+    call_process(receiver, ev, data);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -309,19 +389,76 @@ process_run(void)
   /* Process one event from the queue */
   do_event();
 
-  return nevents + poll_requested;
+  return QUEUED_EVENTS() + poll_requested;
 }
 /*---------------------------------------------------------------------------*/
 int
 process_nevents(void)
 {
-  return nevents + poll_requested;
+  return QUEUED_EVENTS() + poll_requested;
+}
+/*---------------------------------------------------------------------------*/
+#if PROCESS_CONF_STATS
+static void
+count_drop(process_event_t ev)
+{
+  unsigned char i;
+
+  i = ev - PROCESS_EVENT_NONE;
+  if(ev < PROCESS_EVENT_NONE || i >= PROCESS_STATS_EVENTS) {
+    i = PROCESS_STATS_EVENTS - 1;
+  }
+  if(drops[i] < 0xffff) {
+    drops[i]++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+unsigned short
+process_drops(process_event_t ev)
+{
+  unsigned char i;
+
+  i = ev - PROCESS_EVENT_NONE;
+  if(ev < PROCESS_EVENT_NONE || i >= PROCESS_STATS_EVENTS) {
+    i = PROCESS_STATS_EVENTS - 1;
+  }
+  return drops[i];
+}
+#else
+#define count_drop(ev)
+#endif /* PROCESS_CONF_STATS */
+/*---------------------------------------------------------------------------*/
+#if PROCESS_PRIORITIES
+/*
+ * Is there a normal priority event waiting that process p will
+ * receive? A high priority event must not overtake it, processes
+ * expect the events posted to them in order.
+ */
+static int
+normal_pending_for(struct process *p)
+{
+  process_num_events_t i;
+  struct process *receiver;
+
+  if(p == PROCESS_BROADCAST) {
+    return nevents > 0;
+  }
+  for(i = 0; i < nevents; i++) {
+    receiver = events[(fevent + i) % PROCESS_CONF_NUMEVENTS].p;
+    if(receiver == p || receiver == PROCESS_BROADCAST) {
+      return 1;
+    }
+  }
+  return 0;
 }
+#endif /* PROCESS_PRIORITIES */
 /*---------------------------------------------------------------------------*/
 int
-process_post(struct process *p, process_event_t ev, process_data_t data)
+process_post_prio(struct process *p, process_event_t ev, process_data_t data,
+                  unsigned char prio)
 {
   process_num_events_t snum;
+  struct event_data *e;
 
   if(PROCESS_CURRENT() == NULL) {
     PRINTF("process_post: NULL process posts event %d to process '%s', nevents %d\n",
@@ -331,33 +468,85 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
 	   PROCESS_NAME_STRING(PROCESS_CURRENT()), ev,
 	   p == PROCESS_BROADCAST? "<broadcast>": PROCESS_NAME_STRING(p), nevents);
   }
-  
-  if(nevents == PROCESS_CONF_NUMEVENTS) {
+
+  /* A high priority event that cannot go ahead of the normal queue
+     waits in it, exempt from the quota like the event it follows */
+#if PROCESS_PRIORITIES
+  if(prio == PROCESS_PRIO_HIGH &&
+     (nevents_high == PROCESS_CONF_NUMEVENTS_HIGH || normal_pending_for(p))) {
+    prio = PROCESS_PRIO_DEMOTED;
+  }
+
+  if(prio == PROCESS_PRIO_HIGH) {
+    snum = (process_num_events_t)(fevent_high + nevents_high) % PROCESS_CONF_NUMEVENTS_HIGH;
+    e = &events_high[snum];
+    ++nevents_high;
+#if PROCESS_QUOTA
+    e->from = NULL;
+#endif /* PROCESS_QUOTA */
+  } else
+#else /* PROCESS_PRIORITIES */
+  if(prio == PROCESS_PRIO_HIGH) {
+    prio = PROCESS_PRIO_DEMOTED;
+  }
+#endif /* PROCESS_PRIORITIES */
+  {
+    if(nevents == PROCESS_CONF_NUMEVENTS) {
 #if DEBUG
-    if(p == PROCESS_BROADCAST) {
-      printf("soft panic: event queue is full when broadcast event %d was posted from %s\n", ev, PROCESS_NAME_STRING(process_current));
-    } else {
-      printf("soft panic: event queue is full when event %d was posted to %s from %s\n", ev, PROCESS_NAME_STRING(p), PROCESS_NAME_STRING(process_current));
-    }
+      if(p == PROCESS_BROADCAST) {
+        printf("soft panic: event queue is full when broadcast event %d was posted from %s\n", ev, PROCESS_NAME_STRING(process_current));
+      } else {
+        printf("soft panic: event queue is full when event %d was posted to %s from %s\n", ev, PROCESS_NAME_STRING(p), PROCESS_NAME_STRING(process_current));
+      }
 #endif /* DEBUG */
-    return PROCESS_ERR_FULL;
+      count_drop(ev);
+      return PROCESS_ERR_FULL;
+    }
+#if PROCESS_QUOTA
+    if(prio == PROCESS_PRIO_NORMAL &&
+       process_current != NULL && process_current != p &&
+       process_current->nposted >= PROCESS_QUOTA) {
+      PRINTF("process_post: '%s' is over quota\n", PROCESS_NAME_STRING(process_current));
+      count_drop(ev);
+      return PROCESS_ERR_QUOTA;
+    }
+#endif /* PROCESS_QUOTA */
+    snum = (process_num_events_t)(fevent + nevents) % PROCESS_CONF_NUMEVENTS;
+    e = &events[snum];
+    ++nevents;
+#if PROCESS_QUOTA
+    e->from = NULL;
+    if(prio == PROCESS_PRIO_NORMAL &&
+       process_current != NULL && process_current != p) {
+      e->from = process_current;
+      process_current->nposted++;
+    }
+#endif /* PROCESS_QUOTA */
   }
-  
-  snum = (process_num_events_t)(fevent + nevents) % PROCESS_CONF_NUMEVENTS;
-  events[snum].ev = ev;
-  events[snum].data = data;
-  events[snum].p = p;
-  ++nevents;
+  e->ev = ev;
+  e->data = data;
+  e->p = p;
 
 #if PROCESS_CONF_STATS
-  if(nevents > process_maxevents) {
-    process_maxevents = nevents;
+  if(QUEUED_EVENTS() > process_maxevents) {
+    process_maxevents = QUEUED_EVENTS();
+  }
+#if PROCESS_PRIORITIES
+  if(nevents_high > process_maxevents_high) {
+    process_maxevents_high = nevents_high;
   }
+#endif /* PROCESS_PRIORITIES */
 #endif /* PROCESS_CONF_STATS */
-  
+
   return PROCESS_ERR_OK;
 }
 /*---------------------------------------------------------------------------*/
+int
+process_post(struct process *p, process_event_t ev, process_data_t data)
+{
+  return process_post_prio(p, ev, data, PROCESS_EVENT_PRIO(ev));
+}
+/*---------------------------------------------------------------------------*/
 void
 process_post_synch(struct process *p, process_event_t ev, process_data_t data)
 {
@@ -379,6 +568,18 @@ process_poll(struct process *p)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_ACCOUNTING
+void
+process_accounting_reset(void)
+{
+  struct process *p;
+
+  for(p = process_list; p != NULL; p = p->next) {
+    memset(&p->accounting, 0, sizeof(p->accounting));
+  }
+}
+/*---------------------------------------------------------------------------*/
+#endif /* PROCESS_ACCOUNTING */
 int
 process_is_running(struct process *p)
 {
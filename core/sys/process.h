@@ -80,6 +80,15 @@ typedef unsigned char process_num_events_t;
  *             not be posted.
  */
 #define PROCESS_ERR_FULL      1
+/**
+ * \brief      Return value indicating that the posting process has
+ *             used up its quota.
+ *
+ *             This value is returned from process_post() when the
+ *             posting process already has PROCESS_CONF_QUOTA events
+ *             waiting in the normal priority queue.
+ */
+#define PROCESS_ERR_QUOTA     2
 /* @} */
 
 #define PROCESS_NONE          NULL
@@ -88,6 +97,103 @@ typedef unsigned char process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/**
+ * \name Event priority classes
+ *
+ * With PROCESS_CONF_PRIORITIES asynchronous events are kept in two
+ * queues. Events in the high priority queue are delivered before any
+ * event in the normal priority queue, so timer and network events do
+ * not wait behind a burst of application events. The high priority
+ * queue is small and holds PROCESS_CONF_NUMEVENTS_HIGH events.
+ *
+ * A high priority event never overtakes an earlier event for the same
+ * process: it is queued as a normal event when the receiver still has
+ * one waiting, and also when the high priority queue is full.
+ *
+ * process_post() picks the class with PROCESS_EVENT_PRIO(ev), which
+ * can be overridden with PROCESS_CONF_EVENT_PRIO. By default all
+ * events are normal priority and delivered in the order they were
+ * posted. For example
+ *
+ * #define PROCESS_CONF_PRIORITIES 1
+ * #define PROCESS_CONF_EVENT_PRIO(ev) \
+ *   ((ev) == PROCESS_EVENT_TIMER ? PROCESS_PRIO_HIGH : PROCESS_PRIO_NORMAL)
+ *
+ * lets timers through a backlog of application events. Without
+ * PROCESS_CONF_PRIORITIES there is one queue and high priority events
+ * are queued in order with the others.
+ * @{
+ */
+#define PROCESS_PRIO_NORMAL   0
+#define PROCESS_PRIO_HIGH     1
+
+#ifdef PROCESS_CONF_PRIORITIES
+#define PROCESS_PRIORITIES PROCESS_CONF_PRIORITIES
+#else
+#define PROCESS_PRIORITIES 0
+#endif /* PROCESS_CONF_PRIORITIES */
+
+#if PROCESS_PRIORITIES
+#ifndef PROCESS_CONF_NUMEVENTS_HIGH
+#define PROCESS_CONF_NUMEVENTS_HIGH 8
+#endif /* PROCESS_CONF_NUMEVENTS_HIGH */
+#if PROCESS_CONF_NUMEVENTS_HIGH < 1
+#error PROCESS_CONF_NUMEVENTS_HIGH must be at least 1 with PROCESS_CONF_PRIORITIES
+#endif
+#endif /* PROCESS_PRIORITIES */
+
+#ifdef PROCESS_CONF_EVENT_PRIO
+#define PROCESS_EVENT_PRIO(ev) PROCESS_CONF_EVENT_PRIO(ev)
+#else
+#define PROCESS_EVENT_PRIO(ev) PROCESS_PRIO_NORMAL
+#endif /* PROCESS_CONF_EVENT_PRIO */
+/** @} */
+
+/**
+ * Maximum number of normal priority events one process may have
+ * waiting in the queue, 0 means no limit. Events a process posts to
+ * itself, like PROCESS_PAUSE(), and high priority events are not
+ * counted. Posts from interrupt handlers are charged to the process
+ * that ran last.
+ */
+#ifdef PROCESS_CONF_QUOTA
+#define PROCESS_QUOTA PROCESS_CONF_QUOTA
+#else
+#define PROCESS_QUOTA 0
+#endif /* PROCESS_CONF_QUOTA */
+
+/**
+ * With PROCESS_CONF_ACCOUNTING every process counts how often it was
+ * called, how many queued events it received and how long it ran,
+ * measured with RTIMER_NOW(). Run time of a process excludes
+ * processes it calls synchronously.
+ */
+#ifdef PROCESS_CONF_ACCOUNTING
+#define PROCESS_ACCOUNTING PROCESS_CONF_ACCOUNTING
+#else
+#define PROCESS_ACCOUNTING 0
+#endif /* PROCESS_CONF_ACCOUNTING */
+
+#if PROCESS_ACCOUNTING
+struct process_accounting {
+  uint32_t calls, events;
+  /* Cumulative and longest single run, in rtimer ticks */
+  uint32_t time, max;
+};
+#endif /* PROCESS_ACCOUNTING */
+
+/**
+ * Number of per event type drop counters kept with
+ * PROCESS_CONF_STATS. Counters cover events from PROCESS_EVENT_NONE
+ * up, which includes events from process_alloc_event(), the last
+ * counter collects drops of all other events.
+ */
+#ifdef PROCESS_CONF_STATS_EVENTS
+#define PROCESS_STATS_EVENTS PROCESS_CONF_STATS_EVENTS
+#else
+#define PROCESS_STATS_EVENTS 16
+#endif /* PROCESS_CONF_STATS_EVENTS */
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
@@ -323,6 +429,12 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+#if PROCESS_QUOTA
+  process_num_events_t nposted;
+#endif /* PROCESS_QUOTA */
+#if PROCESS_ACCOUNTING
+  struct process_accounting accounting;
+#endif /* PROCESS_ACCOUNTING */
 };
 
 /**
@@ -361,9 +473,31 @@ CCIF void process_start(struct process *p, process_data_t data);
  *
  * \retval PROCESS_ERR_FULL The event queue was full and the event could
  * not be posted.
+ *
+ * \retval PROCESS_ERR_QUOTA The posting process has too many events
+ * waiting in the queue.
+ *
+ * \sa PROCESS_EVENT_PRIO()
  */
 CCIF int process_post(struct process *p, process_event_t ev, process_data_t data);
 
+/**
+ * Post an asynchronous event with explicit priority class.
+ *
+ * \param p The process to which the event should be posted, or
+ * PROCESS_BROADCAST.
+ *
+ * \param ev The event to be posted.
+ *
+ * \param data The auxiliary data to be sent with the event
+ *
+ * \param prio PROCESS_PRIO_HIGH or PROCESS_PRIO_NORMAL
+ *
+ * \return Same values as process_post()
+ */
+CCIF int process_post_prio(struct process *p, process_event_t ev,
+                           process_data_t data, unsigned char prio);
+
 /**
  * Post a synchronous event to a process.
  *
@@ -519,6 +653,36 @@ CCIF int process_is_running(struct process *p);
  */
 int process_nevents(void);
 
+#if PROCESS_CONF_STATS
+/**
+ * Highest number of events waiting since process_init().
+ */
+extern process_num_events_t process_maxevents;
+#if PROCESS_PRIORITIES
+/**
+ * Highest number of events waiting in the high priority queue since
+ * process_init().
+ */
+extern process_num_events_t process_maxevents_high;
+#endif /* PROCESS_PRIORITIES */
+
+/**
+ * Number of events that could not be posted.
+ *
+ * \param ev The event type.
+ * \return Number of drops of the event type, saturated at 0xffff.
+ * Event types without own counter share one.
+ */
+unsigned short process_drops(process_event_t ev);
+#endif /* PROCESS_CONF_STATS */
+
+#if PROCESS_ACCOUNTING
+/**
+ * Clear accounting counters of all processes.
+ */
+void process_accounting_reset(void);
+#endif /* PROCESS_ACCOUNTING */
+
 /** @} */
 
 CCIF extern struct process *process_list;
@@ -54,8 +54,12 @@
 #define PRINTF(...)
 #endif
 
-static struct rtimer *next_rtimer;
+/* Scheduled tasks sorted by time, the first one is the task the
+   hardware timer is set for */
+static struct rtimer *rtimer_queue;
+static volatile uint8_t dispatching;
 
+static rtimer_clock_t max_latency[RTIMER_PRIORITY_HIGH + 1];
 /*---------------------------------------------------------------------------*/
 void
 rtimer_init(void)
@@ -63,45 +67,176 @@ rtimer_init(void)
   rtimer_arch_init();
 }
 /*---------------------------------------------------------------------------*/
+/* Removes task from queue, returns 0 if it was not scheduled. Must be
+   called inside critical section. */
+static int
+dequeue(struct rtimer *rtimer)
+{
+  struct rtimer **tp;
+
+  for(tp = &rtimer_queue; *tp != NULL; tp = &(*tp)->next) {
+    if(*tp == rtimer) {
+      *tp = rtimer->next;
+      rtimer->next = NULL;
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Inserts task behind all tasks scheduled at the same time or earlier.
+   Times are compared relative to the current time due to wraps. */
+static void
+enqueue(struct rtimer *rtimer, rtimer_clock_t now)
+{
+  struct rtimer **tp;
+
+  for(tp = &rtimer_queue;
+      *tp != NULL && RTIMER_CLOCK_DIFF((*tp)->time, now) <=
+        RTIMER_CLOCK_DIFF(rtimer->time, now);
+      tp = &(*tp)->next);
+  rtimer->next = *tp;
+  *tp = rtimer;
+}
+/*---------------------------------------------------------------------------*/
+/* Sets hardware timer for the first task, tasks which are due are
+   scheduled RTIMER_GUARD_TIME in the future */
+static void
+schedule_first(rtimer_clock_t now)
+{
+  struct rtimer *t;
+  rtimer_clock_t time;
+
+  if(rtimer_queue == NULL) {
+    return;
+  }
+  time = rtimer_queue->time;
+  /* Normal priority tasks wait for high priority task close to them */
+  for(t = rtimer_queue; t != NULL &&
+        RTIMER_CLOCK_DIFF(t->time, rtimer_queue->time) <= RTIMER_PRIORITY_GUARD;
+      t = t->next) {
+    if(t->priority == RTIMER_PRIORITY_HIGH) {
+      time = t->time;
+      break;
+    }
+  }
+  if(RTIMER_CLOCK_LT(time, now + RTIMER_GUARD_TIME + 1)) {
+    time = now + RTIMER_GUARD_TIME + 1;
+  }
+  rtimer_arch_schedule(time);
+}
+/*---------------------------------------------------------------------------*/
 int
 rtimer_set(struct rtimer *rtimer, rtimer_clock_t time,
 	   rtimer_clock_t duration,
 	   rtimer_callback_t func, void *ptr)
 {
-  int first = 0;
+  rtimer_clock_t now;
+  struct rtimer *first;
+  RTIMER_ARCH_CRITICAL_STATE(state);
 
   PRINTF("rtimer_set time %d\n", time);
 
-  if(next_rtimer == NULL) {
-    first = 1;
+  RTIMER_ARCH_CRITICAL_ENTER(state);
+
+#if !RTIMER_ARCH_HAS_CRITICAL
+  /* The rtimer interrupt could preempt a queue walk, outside of rtimer
+     callbacks the task replaces all scheduled tasks, like the single
+     task rtimer did */
+  if(!dispatching) {
+    rtimer_queue = NULL;
   }
+#endif /* !RTIMER_ARCH_HAS_CRITICAL */
+
+  now = RTIMER_NOW();
+  first = rtimer_queue;
+  dequeue(rtimer);
 
   rtimer->func = func;
   rtimer->ptr = ptr;
-
   rtimer->time = time;
-  next_rtimer = rtimer;
+  enqueue(rtimer, now);
 
-  if(first == 1) {
-    rtimer_arch_schedule(time);
+  /* Inside of rtimer_run_next() the hardware timer is set when all
+     due tasks are executed */
+  if(!dispatching && (rtimer_queue != first || rtimer_queue == rtimer)) {
+    schedule_first(now);
   }
+
+  RTIMER_ARCH_CRITICAL_EXIT(state);
   return RTIMER_OK;
 }
 /*---------------------------------------------------------------------------*/
+/* Returns the task to execute next or NULL if no task is due. High
+   priority tasks go first, normal priority tasks due within
+   RTIMER_PRIORITY_GUARD before a high priority task wait for it. */
+static struct rtimer *
+next_due(rtimer_clock_t now)
+{
+  struct rtimer *t;
+
+  for(t = rtimer_queue; t != NULL &&
+        RTIMER_CLOCK_DIFF(t->time, now) <= RTIMER_PRIORITY_GUARD;
+      t = t->next) {
+    if(t->priority == RTIMER_PRIORITY_HIGH) {
+      return RTIMER_CLOCK_LT(now, t->time) ? NULL : t;
+    }
+  }
+  t = rtimer_queue;
+  return t != NULL && !RTIMER_CLOCK_LT(now, t->time) ? t : NULL;
+}
+/*---------------------------------------------------------------------------*/
 void
 rtimer_run_next(void)
 {
   struct rtimer *t;
-  if(next_rtimer == NULL) {
-    return;
-  }
-  t = next_rtimer;
-  next_rtimer = NULL;
-  t->func(t, t->ptr);
-  if(next_rtimer != NULL) {
-    rtimer_arch_schedule(next_rtimer->time);
+  rtimer_clock_t now, latency;
+  int n;
+  RTIMER_ARCH_CRITICAL_STATE(state);
+
+  RTIMER_ARCH_CRITICAL_ENTER(state);
+  dispatching = 1;
+
+  /* At most RTIMER_MAX_DISPATCH tasks are executed in one interrupt,
+     remaining tasks are executed by the next one */
+  for(n = 0; n < RTIMER_MAX_DISPATCH; n++) {
+    now = RTIMER_NOW();
+    if(n == 0 && rtimer_queue != NULL &&
+       RTIMER_CLOCK_LT(now, rtimer_queue->time) &&
+       RTIMER_CLOCK_DIFF(rtimer_queue->time, now) <= RTIMER_GUARD_TIME) {
+      /* The hardware timer may fire slightly early, the task it was
+         set for is executed anyway. A stale interrupt, e.g. after the
+         task was moved later, does not execute it. */
+      now = rtimer_queue->time;
+    }
+    t = next_due(now);
+    if(t == NULL) {
+      break;
+    }
+    dequeue(t);
+
+    latency = RTIMER_NOW() - t->time;
+    if(RTIMER_CLOCK_DIFF(latency, 0) > 0 && latency > max_latency[t->priority]) {
+      max_latency[t->priority] = latency;
+    }
+
+    RTIMER_ARCH_CRITICAL_EXIT(state);
+    t->func(t, t->ptr);
+    RTIMER_ARCH_CRITICAL_ENTER(state);
   }
-  return;
+
+  dispatching = 0;
+  schedule_first(RTIMER_NOW());
+  RTIMER_ARCH_CRITICAL_EXIT(state);
+}
+/*---------------------------------------------------------------------------*/
+rtimer_clock_t
+rtimer_max_latency(uint8_t priority)
+{
+  rtimer_clock_t latency = max_latency[priority];
+
+  max_latency[priority] = 0;
+  return latency;
 }
 /*---------------------------------------------------------------------------*/
 
@@ -87,8 +87,19 @@ struct rtimer {
   rtimer_clock_t time;
   rtimer_callback_t func;
   void *ptr;
+  struct rtimer *next;
+  uint8_t priority;
 };
 
+/**
+ * Task priorities. When a normal priority task is due less than
+ * RTIMER_PRIORITY_GUARD ticks before a high priority task, it is
+ * executed after the high priority task, so MAC timing is not
+ * disturbed by other tasks.
+ */
+#define RTIMER_PRIORITY_NORMAL 0
+#define RTIMER_PRIORITY_HIGH   1
+
 enum {
   RTIMER_OK,
   RTIMER_ERR_FULL,
@@ -96,6 +107,17 @@ enum {
   RTIMER_ERR_ALREADY_SCHEDULED,
 };
 
+/**
+ * \brief      Set priority of a real-time task
+ * \param task A pointer to the task
+ * \param prio RTIMER_PRIORITY_NORMAL (default) or RTIMER_PRIORITY_HIGH
+ *
+ *             The priority is kept when the task is posted again.
+ *
+ * \hideinitializer
+ */
+#define rtimer_set_priority(task, prio) ((task)->priority = (prio))
+
 /**
  * \brief      Post a real-time task.
  * \param task A pointer to the task variable previously declared with RTIMER_TASK().
@@ -107,7 +129,14 @@ enum {
  *             (false) if the task could not be scheduled.
  *
  *             This function schedules a real-time task at a specified
- *             time in the future.
+ *             time in the future. Any number of tasks may be
+ *             scheduled at the same time, posting a task which is
+ *             already scheduled moves it to the new time.
+ *
+ *             On ports without RTIMER_ARCH_CRITICAL_ENTER() only
+ *             rtimer callbacks add tasks to the queue, a task posted
+ *             elsewhere replaces the scheduled tasks, see
+ *             RTIMER_ARCH_HAS_CRITICAL.
  *
  */
 int rtimer_set(struct rtimer *task, rtimer_clock_t time,
@@ -122,6 +151,16 @@ int rtimer_set(struct rtimer *task, rtimer_clock_t time,
  */
 void rtimer_run_next(void);
 
+/**
+ * \brief      Get the maximum dispatch latency
+ * \param prio Priority of tasks
+ * \return     Longest time between the scheduled time of a task and
+ *             execution of its callback since the last call
+ *
+ *             The maximum is reset by this call.
+ */
+rtimer_clock_t rtimer_max_latency(uint8_t prio);
+
 /**
  * \brief      Get the current clock time
  * \return     The current time
@@ -163,6 +202,40 @@ void rtimer_arch_schedule(rtimer_clock_t t);
 #define RTIMER_GUARD_TIME (RTIMER_ARCH_SECOND >> 14)
 #endif /* RTIMER_CONF_GUARD_TIME */
 
+/* RTIMER_PRIORITY_GUARD is the time in rtimer ticks a normal priority
+   task is delayed at most when a high priority task is due after it. */
+#ifdef RTIMER_CONF_PRIORITY_GUARD
+#define RTIMER_PRIORITY_GUARD RTIMER_CONF_PRIORITY_GUARD
+#else /* RTIMER_CONF_PRIORITY_GUARD */
+#define RTIMER_PRIORITY_GUARD (RTIMER_ARCH_SECOND / 1000 + 1)
+#endif /* RTIMER_CONF_PRIORITY_GUARD */
+
+/* RTIMER_MAX_DISPATCH is the maximum number of tasks executed by one
+   rtimer interrupt, it bounds the time spent in the interrupt. */
+#ifdef RTIMER_CONF_MAX_DISPATCH
+#define RTIMER_MAX_DISPATCH RTIMER_CONF_MAX_DISPATCH
+#else /* RTIMER_CONF_MAX_DISPATCH */
+#define RTIMER_MAX_DISPATCH 4
+#endif /* RTIMER_CONF_MAX_DISPATCH */
+
+/* The task queue is shared by rtimer interrupt and code calling
+   rtimer_set(). Ports define these to disable the rtimer interrupt
+   around queue updates. State holds the previous interrupt state, so
+   critical sections nest.
+
+   On ports which do not define them, the queue can only be updated
+   safely from rtimer callbacks. There rtimer_set() called from
+   elsewhere drops the scheduled tasks and schedules only the new one,
+   as it did when only one task could be scheduled. */
+#ifdef RTIMER_ARCH_CRITICAL_ENTER
+#define RTIMER_ARCH_HAS_CRITICAL 1
+#else /* RTIMER_ARCH_CRITICAL_ENTER */
+#define RTIMER_ARCH_HAS_CRITICAL 0
+#define RTIMER_ARCH_CRITICAL_STATE(state)
+#define RTIMER_ARCH_CRITICAL_ENTER(state)
+#define RTIMER_ARCH_CRITICAL_EXIT(state)
+#endif /* RTIMER_ARCH_CRITICAL_ENTER */
+
 #endif /* RTIMER_H_ */
 
 /** @} */
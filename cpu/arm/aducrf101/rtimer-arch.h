@@ -39,6 +39,13 @@
 #define __RTIMER_ARCH_H__
 
 #include <stdint.h>
+#include <aducrf101-include.h>
+
+/* The rtimer task queue is updated with interrupts disabled */
+#define RTIMER_ARCH_CRITICAL_STATE(state) uint32_t state
+#define RTIMER_ARCH_CRITICAL_ENTER(state) \
+  do { state = __get_PRIMASK(); __disable_irq(); } while(0)
+#define RTIMER_ARCH_CRITICAL_EXIT(state)  __set_PRIMASK(state)
 
 #define RTIMER_ARCH_SECOND (32768)
 
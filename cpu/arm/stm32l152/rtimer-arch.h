@@ -34,7 +34,14 @@
 #ifndef __RTIMER_ARCH_H__
 #define __RTIMER_ARCH_H__
 /*---------------------------------------------------------------------------*/
+/* The rtimer task queue is updated with interrupts disabled */
+#define RTIMER_ARCH_CRITICAL_STATE(state) uint32_t state
+#define RTIMER_ARCH_CRITICAL_ENTER(state) \
+  do { state = __get_PRIMASK(); __disable_irq(); } while(0)
+#define RTIMER_ARCH_CRITICAL_EXIT(state)  __set_PRIMASK(state)
+
 #include "contiki-conf.h"
+#include "stm32l1xx.h"
 #include "sys/clock.h"
 /*---------------------------------------------------------------------------*/
 rtimer_clock_t rtimer_arch_now(void);
@@ -35,6 +35,11 @@
 
 #include <avr/interrupt.h>
 
+/* The rtimer task queue is updated with interrupts disabled */
+#define RTIMER_ARCH_CRITICAL_STATE(state) uint8_t state
+#define RTIMER_ARCH_CRITICAL_ENTER(state) do { state = SREG; cli(); } while(0)
+#define RTIMER_ARCH_CRITICAL_EXIT(state)  (SREG = (state))
+
 /* Nominal ARCH_SECOND is F_CPU/prescaler, e.g. 8000000/1024 = 7812
  * Other prescaler values (1, 8, 64, 256) will give greater precision
  * with shorter maximum intervals.
@@ -60,7 +60,14 @@
 #ifndef RTIMER_ARCH_H_
 #define RTIMER_ARCH_H_
 
+/* The rtimer task queue is updated with interrupts disabled */
+#define RTIMER_ARCH_CRITICAL_STATE(state) uint32_t state
+#define RTIMER_ARCH_CRITICAL_ENTER(state) \
+  do { state = __get_PRIMASK(); __disable_irq(); } while(0)
+#define RTIMER_ARCH_CRITICAL_EXIT(state)  __set_PRIMASK(state)
+
 #include "contiki.h"
+#include "cpu.h"
 #include "dev/gptimer.h"
 
 #define RTIMER_ARCH_SECOND 32768
@@ -44,6 +44,11 @@
 #ifndef RTIMER_ARCH_H_
 #define RTIMER_ARCH_H_
 
+/* The rtimer task queue is updated with interrupts disabled */
+#define RTIMER_ARCH_CRITICAL_STATE(state) uint8_t state
+#define RTIMER_ARCH_CRITICAL_ENTER(state) do { state = EA; EA = 0; } while(0)
+#define RTIMER_ARCH_CRITICAL_EXIT(state)  (EA = (state))
+
 #include "contiki-conf.h"
 #include "cc253x.h"
 
@@ -45,7 +45,15 @@
 #ifndef RTIMER_ARCH_H_
 #define RTIMER_ARCH_H_
 /*---------------------------------------------------------------------------*/
+/* The rtimer task queue is updated with interrupts disabled */
+#define RTIMER_ARCH_CRITICAL_STATE(state) uint8_t state
+#define RTIMER_ARCH_CRITICAL_ENTER(state) \
+  ((state) = ti_lib_int_master_disable())
+#define RTIMER_ARCH_CRITICAL_EXIT(state) \
+  do { if(!(state)) { ti_lib_int_master_enable(); } } while(0)
+
 #include "contiki.h"
+#include "ti-lib.h"
 /*---------------------------------------------------------------------------*/
 #define RTIMER_ARCH_SECOND 65536
 /*---------------------------------------------------------------------------*/
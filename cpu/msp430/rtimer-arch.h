@@ -41,6 +41,12 @@
 #define RTIMER_ARCH_H_
 
 #include "sys/rtimer.h"
+#include "msp430def.h"
+
+/* The rtimer task queue is updated with interrupts disabled */
+#define RTIMER_ARCH_CRITICAL_STATE(state) spl_t state
+#define RTIMER_ARCH_CRITICAL_ENTER(state) ((state) = splhigh())
+#define RTIMER_ARCH_CRITICAL_EXIT(state)  splx(state)
 
 #ifdef RTIMER_CONF_SECOND
 #define RTIMER_ARCH_SECOND RTIMER_CONF_SECOND
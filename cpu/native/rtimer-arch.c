@@ -45,6 +45,15 @@
 
 #include "sys/rtimer.h"
 #include "sys/clock.h"
+#include "sys/process.h"
+
+/* Called from the signal handler when rtimer tasks have polled or
+   posted to processes, so the main loop does not keep sleeping */
+#ifdef RTIMER_ARCH_CONF_WAKEUP
+#define RTIMER_ARCH_WAKEUP() RTIMER_ARCH_CONF_WAKEUP()
+#else /* RTIMER_ARCH_CONF_WAKEUP */
+#define RTIMER_ARCH_WAKEUP()
+#endif /* RTIMER_ARCH_CONF_WAKEUP */
 
 #define DEBUG 0
 #if DEBUG
@@ -60,6 +69,9 @@ interrupt(int sig)
 {
   signal(sig, interrupt);
   rtimer_run_next();
+  if(process_nevents() > 0) {
+    RTIMER_ARCH_WAKEUP();
+  }
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -46,4 +46,19 @@
 
 #define rtimer_arch_now() clock_time()
 
+#ifndef _WIN32
+#include <signal.h>
+
+/* Tasks are executed from SIGALRM handler, which is blocked while the
+   rtimer task queue is updated */
+#define RTIMER_ARCH_CRITICAL_STATE(state) sigset_t state
+#define RTIMER_ARCH_CRITICAL_ENTER(state) do {          \
+    sigset_t rtimer_arch_alarm;                         \
+    sigemptyset(&rtimer_arch_alarm);                    \
+    sigaddset(&rtimer_arch_alarm, SIGALRM);             \
+    sigprocmask(SIG_BLOCK, &rtimer_arch_alarm, &(state)); \
+  } while(0)
+#define RTIMER_ARCH_CRITICAL_EXIT(state) sigprocmask(SIG_SETMASK, &(state), NULL)
+#endif /* !_WIN32 */
+
 #endif /* RTIMER_ARCH_H_ */
@@ -41,7 +41,14 @@
 #ifndef RTIMER_ARCH_H_
 #define RTIMER_ARCH_H_
 /*---------------------------------------------------------------------------*/
+/* The rtimer task queue is updated with interrupts disabled */
+#define RTIMER_ARCH_CRITICAL_STATE(state) uint32_t state
+#define RTIMER_ARCH_CRITICAL_ENTER(state) \
+  do { state = __get_PRIMASK(); __disable_irq(); } while(0)
+#define RTIMER_ARCH_CRITICAL_EXIT(state)  __set_PRIMASK(state)
+
 #include "contiki.h"
+#include "nrf.h"
 /*---------------------------------------------------------------------------*/
 rtimer_clock_t rtimer_arch_now(void);
 /*---------------------------------------------------------------------------*/
@@ -30,6 +30,9 @@
 
 
 extern resource_t res_example;
+#if defined(HETEROGENEOUS_STATISTICS) && defined(COAP_HETEROGENEOUS)
+extern resource_t res_statistics;
+#endif
 
 /*variable from symbols.h - used in example resource if temperature is not used*/
 extern int variable=100; 
@@ -107,6 +110,9 @@ PROCESS_THREAD(coapv2_example_server, ev, data)
 
   /*Activate resource*/
   rest_activate_resource(&res_example, "test/example");
+#if defined(HETEROGENEOUS_STATISTICS) && defined(COAP_HETEROGENEOUS)
+  rest_activate_resource(&res_statistics, "desider/stats");
+#endif
 
   /*Activate button*/
   SENSORS_ACTIVATE(button_sensor);
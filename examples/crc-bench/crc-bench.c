@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+/**
+ * \file
+ *         Micro-benchmark of the CRC modules on native platform. Checks
+ *         the standard check values, then reports throughput of
+ *         crc16_data(), crc32_data() and crc32c_data() for a radio
+ *         frame sized and a file sized block, and of a byte-by-byte
+ *         crc16_add() loop. Results go to stderr.
+ *
+ *         ./crc-bench.native [-m <megabytes per run>]
+ *
+ *         "make bench" runs it for every CRC_METHOD_*.
+ */
+
+#include "contiki.h"
+#include "lib/crc16.h"
+#include "lib/crc32.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BLOCK_SIZE 4096
+#define FRAME_SIZE 127
+
+extern int contiki_argc;
+extern char **contiki_argv;
+
+static unsigned char block[BLOCK_SIZE];
+static unsigned long megabytes = 64;
+
+/* Keeps results alive so the loops are not optimized out */
+static volatile uint32_t sink;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(crc_bench_process, "CRC benchmark");
+AUTOSTART_PROCESSES(&crc_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+run_crc16(const unsigned char *data, int len, uint32_t acc)
+{
+  return crc16_data(data, len, acc);
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+run_crc16_add(const unsigned char *data, int len, uint32_t acc)
+{
+  int i;
+
+  for(i = 0; i < len; i++) {
+    acc = crc16_add(data[i], acc);
+  }
+  return acc;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+run_crc32(const unsigned char *data, int len, uint32_t acc)
+{
+  return crc32_data(data, len, acc);
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+run_crc32c(const unsigned char *data, int len, uint32_t acc)
+{
+  return crc32c_data(data, len, acc);
+}
+/*---------------------------------------------------------------------------*/
+static void
+measure(const char *name, uint32_t (*run)(const unsigned char *, int, uint32_t),
+        int len)
+{
+  unsigned long long start, elapsed;
+  unsigned long i, rounds;
+  uint32_t acc = 0;
+
+  rounds = megabytes * 1024 * 1024 / len;
+  start = now_ns();
+  for(i = 0; i < rounds; i++) {
+    acc = run(block, len, acc);
+  }
+  elapsed = now_ns() - start;
+  sink = acc;
+
+  fprintf(stderr, "crc-bench: %-10s %4d bytes %8.1f MB/s %6.2f ns/byte\n",
+          name, len, (double)rounds * len / (elapsed / 1e9) / 1e6,
+          (double)elapsed / ((double)rounds * len));
+}
+/*---------------------------------------------------------------------------*/
+static int
+check(void)
+{
+  static const unsigned char text[] = "123456789";
+  int ok = 1;
+
+  if(crc16_data(text, 9, 0) != 0x2189) {
+    fprintf(stderr, "crc-bench: crc16 check value mismatch\n");
+    ok = 0;
+  }
+  if(crc32_data(text, 9, 0) != 0xcbf43926UL) {
+    fprintf(stderr, "crc-bench: crc32 check value mismatch\n");
+    ok = 0;
+  }
+  if(crc32c_data(text, 9, 0) != 0xe3069283UL) {
+    fprintf(stderr, "crc-bench: crc32c check value mismatch\n");
+    ok = 0;
+  }
+  /* Streaming in two parts must give the same checksum */
+  if(crc32_data(block + 1000, BLOCK_SIZE - 1000, crc32_data(block, 1000, 0)) !=
+     crc32_data(block, BLOCK_SIZE, 0)) {
+    fprintf(stderr, "crc-bench: crc32 streaming mismatch\n");
+    ok = 0;
+  }
+  return ok;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(crc_bench_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+
+  for(i = 1; i + 1 < contiki_argc; i += 2) {
+    if(!strcmp(contiki_argv[i], "-m")) {
+      megabytes = strtoul(contiki_argv[i + 1], NULL, 10);
+    }
+  }
+
+  for(i = 0; i < BLOCK_SIZE; i++) {
+    block[i] = random_rand();
+  }
+  if(!check()) {
+    exit(1);
+  }
+
+  fprintf(stderr, "crc-bench: crc16 method %d, crc32 method %d, %lu MB per run\n",
+          CRC16_CONF_METHOD, CRC32_CONF_METHOD, megabytes);
+  measure("crc16_add", run_crc16_add, BLOCK_SIZE);
+  measure("crc16", run_crc16, FRAME_SIZE);
+  measure("crc16", run_crc16, BLOCK_SIZE);
+  measure("crc32", run_crc32, FRAME_SIZE);
+  measure("crc32", run_crc32, BLOCK_SIZE);
+  measure("crc32c", run_crc32c, FRAME_SIZE);
+  measure("crc32c", run_crc32c, BLOCK_SIZE);
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+/**
+ * \file
+ *         Benchmark of heterogeneous desider on native platform. Sends
+ *         packets of configurable flow mix through the desider and reports
+ *         decision latency and packets per second per technology to stderr.
+ *         Stdout and stdin are serial line to linux device, run it under
+ *         wifi-peer which stands in for linux device:
+ *
+ *         ./wifi-peer [peer options] ./desider-bench.native [options]
+ *
+ *         -n <packets>  number of packets (default 10000)
+ *         -f <flows>    number of destinations (default 4)
+ *         -e <percent>  share of energy sensitive packets (default 50)
+ *         -s <bytes>    payload size (default 32)
+ *         -b <packets>  packets sent in one process run (default 16)
+ *         -t <count>    simulated technologies registered besides rpl and
+ *                       wifi, with the metrics of rpl (default 0, max 2)
+ *
+ *         Packets of one flow are spread over technologies of similar
+ *         cost when built with SPLIT=1.
+ */
+
+#include "contiki.h"
+#include "sys/etimer.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "simple-udp.h"
+#include "heterogeneous-desider.h"
+#include "sim-technology.h"
+#include "statistics.h"
+#include "pending.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define UDP_PORT 1234
+#define MAX_PAYLOAD 512
+#define METRICS_WAIT (5 * CLOCK_SECOND)
+
+extern int contiki_argc;
+extern char **contiki_argv;
+
+static struct simple_udp_connection connection;
+
+static unsigned long packets = 10000;
+static unsigned int flows = 4;
+static unsigned int energy_share = 50;
+static unsigned int payload_size = 32;
+static unsigned int burst = 16;
+static unsigned int sim_count = 0;
+
+static uint8_t payload[MAX_PAYLOAD];
+
+/* Stand-ins for further radios, their packets are only counted */
+static SIM_TECHNOLOGY(sim0, 3, 50, 1);
+static SIM_TECHNOLOGY(sim1, 4, 100, 1);
+static sim_technology *const sims[] = { &sim0, &sim1 };
+#define MAX_SIMS (sizeof(sims) / sizeof(sims[0]))
+
+static unsigned long long latency_sum, latency_min, latency_max;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(desider_bench_process, "Desider benchmark");
+AUTOSTART_PROCESSES(&desider_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+parse_arguments(void)
+{
+  int i;
+
+  for(i = 1; i + 1 < contiki_argc; i += 2) {
+    unsigned long value = strtoul(contiki_argv[i + 1], NULL, 10);
+
+    if(!strcmp(contiki_argv[i], "-n")) {
+      packets = value;
+    } else if(!strcmp(contiki_argv[i], "-f")) {
+      flows = value > 0 ? value : 1;
+    } else if(!strcmp(contiki_argv[i], "-e")) {
+      energy_share = value > 100 ? 100 : value;
+    } else if(!strcmp(contiki_argv[i], "-s")) {
+      payload_size = value > MAX_PAYLOAD ? MAX_PAYLOAD : value;
+    } else if(!strcmp(contiki_argv[i], "-b")) {
+      burst = value > 0 ? value : 1;
+    } else if(!strcmp(contiki_argv[i], "-t")) {
+      sim_count = value > MAX_SIMS ? MAX_SIMS : value;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static uip_ipaddr_t *
+set_global_address(void)
+{
+  static uip_ipaddr_t ipaddr;
+
+  uip_ip6addr(&ipaddr, 0xaaaa, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&ipaddr, &uip_lladdr);
+  uip_ds6_addr_add(&ipaddr, 0, ADDR_AUTOCONF);
+  return &ipaddr;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Builds payload of packet number n. Keys of simple UDP flows are taken from
+ * number at the start of payload, 0 is energy sensitive (en 50), 2 is not.
+ */
+static uint16_t
+build_payload(unsigned long n, uint8_t *en)
+{
+  unsigned int value = (n % 100) < energy_share ? 0 : 2;
+  int len;
+
+  len = snprintf((char *)payload, sizeof(payload), "%u;", value);
+  if(len < payload_size) {
+    memset(payload + len, 'x', payload_size - len);
+    len = payload_size;
+  }
+  *en = value == 0 ? 50 : 1;
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_packet(unsigned long n)
+{
+  uip_ipaddr_t to;
+  uint16_t len;
+  uint8_t en;
+  unsigned long long start, latency;
+
+  uip_ip6addr(&to, 0xaaaa, 0, 0, 0, 0, 0, 0, (n % flows) + 2);
+  len = build_payload(n, &en);
+
+  start = now_ns();
+  heterogenous_simple_udp_sendto(&connection, payload, len, &to);
+  latency = now_ns() - start;
+
+  latency_sum += latency;
+  if(n == 0 || latency < latency_min) {
+    latency_min = latency;
+  }
+  if(latency > latency_max) {
+    latency_max = latency;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Packets counted by the desider when they were actually sent */
+static unsigned long
+sent_packets(uint8_t technology)
+{
+  const tech_statistics *t = statistics_technology(technology);
+
+  return t != NULL ? t->packets : 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(unsigned long long elapsed, unsigned int held)
+{
+  double seconds = elapsed / 1e9;
+  unsigned int i;
+
+  fprintf(stderr, "bench: packets %lu flows %u energy %u%% size %u burst %u\n",
+          packets, flows, energy_share, payload_size, burst);
+  if(packets == 0) {
+    return;
+  }
+  fprintf(stderr, "bench: decision latency ns min %llu avg %llu max %llu\n",
+          latency_min, latency_sum / packets, latency_max);
+  fprintf(stderr, "bench: elapsed %.3f s, %.0f packets/s\n",
+          seconds, packets / seconds);
+  fprintf(stderr, "bench: sent rpl %lu wifi %lu, held %u after sending, %u unsent\n",
+          sent_packets(RPL_TECHNOLOGY), sent_packets(WIFI_TECHNOLOGY),
+          held, pending_count());
+  for(i = 0; i < sim_count; i++) {
+    fprintf(stderr, "bench: sent %s %lu (%lu bytes)\n",
+            sims[i]->driver.name, (unsigned long)sims[i]->packets,
+            (unsigned long)sims[i]->bytes);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(desider_bench_process, ev, data)
+{
+  static struct etimer timer;
+  static unsigned long n;
+  static unsigned long long start, elapsed;
+  static unsigned int held;
+  static clock_time_t wait_start;
+  unsigned int i;
+
+  PROCESS_BEGIN();
+
+  parse_arguments();
+
+  simple_udp_register(&connection, UDP_PORT, NULL, UDP_PORT, NULL);
+  init_module(MODE_ROOT, set_global_address());
+
+  for(i = 0; i < sim_count; i++) {
+    register_technology(&sims[i]->driver);
+    add_metrics(sims[i]->driver.type, DEFAULT_RPL_EN, DEFAULT_RPL_BW, DEFAULT_RPL_ETX);
+  }
+
+  /* linux device registers wifi metrics after boot message */
+  wait_start = clock_time();
+  while(find_metrics_by_tech_type(WIFI_TECHNOLOGY) == NULL &&
+        clock_time() - wait_start < METRICS_WAIT) {
+    etimer_set(&timer, CLOCK_SECOND / 10);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
+  }
+  if(find_metrics_by_tech_type(WIFI_TECHNOLOGY) == NULL) {
+    fprintf(stderr, "bench: no wifi metrics received, running with rpl only\n");
+  }
+
+  start = now_ns();
+  for(n = 0; n < packets;) {
+    for(i = 0; i < burst && n < packets; i++, n++) {
+      send_packet(n);
+    }
+    /* lets serial connection process answers of linux device */
+    PROCESS_PAUSE();
+  }
+  elapsed = now_ns() - start;
+  held = pending_count();
+
+  /* held packets are sent when answers arrive or pending timeout expires */
+  etimer_set(&timer, 2 * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&timer));
+  report(elapsed, held);
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+#define SERIAL_LINE_CONF_BUFSIZE 128
+
+#define HETEROGENEOUS_CONF_MAX_FLOWS 32
+
+/* Packets are counted by technology they were sent with */
+#define HETEROGENEOUS_STATISTICS 1
+
+/* rpl, wifi and two simulated technologies */
+#define HETEROGENEOUS_CONF_MAX_TECHNOLOGIES 4
+
+#endif /* PROJECT_CONF_H_ */
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+/**
+ * \file
+ *         Stand-in for linux device of heterogeneous desider. Runs mote
+ *         program (native build) with its serial line connected to a pty
+ *         and speaks serial protocol with it: registers wifi metrics after
+ *         boot, answers route questions and counts packets sent using wifi.
+ *         Statistics are printed to stderr when mote program exits.
+ *
+ *         wifi-peer [-e en] [-b bw] [-x etx] [-m mode] [-r reachable] [-v]
+ *                   -- <mote program> [arguments]
+ *
+ *         -m  serial mode requested from mote (0 ASCII, 1 binary, 2 batch)
+ *         -r  answer of route questions (1 reachable using wifi, 0 not)
+ *         -v  print lines received from mote
+ */
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define SLIP_END     0300
+#define SLIP_ESC     0333
+#define SLIP_ESC_END 0334
+#define SLIP_ESC_ESC 0335
+
+#define BUF_SIZE 2048
+
+static int en = 2, bw = 20, etx = 5, mode = 0, reachable = 1, verbose = 0;
+static int master;
+
+static char line[BUF_SIZE];
+static int line_len;
+static unsigned char frame[BUF_SIZE];
+static int frame_len, in_frame, esc;
+
+static unsigned long serial_bytes, packet_bytes, packets, questions, frames;
+/*---------------------------------------------------------------------------*/
+static void
+send_string(const char *s)
+{
+  if(write(master, s, strlen(s)) < 0) {
+    perror("write");
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+handle_line(void)
+{
+  char answer[64];
+
+  line[line_len] = '\0';
+  if(verbose) {
+    fprintf(stderr, "mote: %s\n", line);
+  }
+  if(!strncmp(line, "!b", 2) || !strncmp(line, "?w", 2)) {
+    snprintf(answer, sizeof(answer), "!we%db%dx%d\n", en, bw, etx);
+    send_string(answer);
+    if(line[0] == '!' && mode) {
+      snprintf(answer, sizeof(answer), "!m%d\n", mode);
+      send_string(answer);
+    }
+  } else if(!strncmp(line, "?p;", 3)) {
+    questions++;
+    snprintf(answer, sizeof(answer), "$p;%d;%d;\n", atoi(line + 3), reachable);
+    send_string(answer);
+  } else if(!strncmp(line, "!p;", 3)) {
+    packets++;
+    packet_bytes += line_len + 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Frame is <type><body><crc16>, crc is not checked, pty does not lose bytes
+ */
+static void
+handle_frame(int len)
+{
+  int i;
+
+  frames++;
+  if(len < 3) {
+    return;
+  }
+  if(frame[0] == 'p') {
+    packets++;
+    packet_bytes += len + 2;
+  } else if(frame[0] == 'b') {
+    packet_bytes += len + 2;
+    for(i = 1; i < len - 2 && frame[i] > 0; i += 1 + frame[i]) {
+      if(frame[i + 1] == 'p') {
+        packets++;
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+input_byte(unsigned char c)
+{
+  serial_bytes++;
+  if(c == SLIP_END) {
+    if(in_frame) {
+      handle_frame(frame_len);
+    }
+    in_frame = !in_frame;
+    frame_len = 0;
+    esc = 0;
+    return;
+  }
+  if(in_frame) {
+    if(esc) {
+      esc = 0;
+      c = c == SLIP_ESC_END ? SLIP_END : c == SLIP_ESC_ESC ? SLIP_ESC : c;
+    } else if(c == SLIP_ESC) {
+      esc = 1;
+      return;
+    }
+    if(frame_len < BUF_SIZE) {
+      frame[frame_len++] = c;
+    }
+    return;
+  }
+  if(c == '\n' || c == '\r') {
+    if(line_len > 0) {
+      handle_line();
+    }
+    line_len = 0;
+  } else if(line_len < BUF_SIZE - 1) {
+    line[line_len++] = c;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [-e en] [-b bw] [-x etx] [-m mode] [-r reachable] [-v] -- program [args]\n",
+          name);
+  exit(1);
+}
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+  struct termios tio;
+  struct timeval start, end;
+  unsigned char buf[BUF_SIZE];
+  double seconds;
+  pid_t pid;
+  int i, len, slave, status;
+
+  for(i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if(!strcmp(argv[i], "--")) {
+      i++;
+      break;
+    } else if(!strcmp(argv[i], "-v")) {
+      verbose = 1;
+    } else if(i + 1 < argc && !strcmp(argv[i], "-e")) {
+      en = atoi(argv[++i]);
+    } else if(i + 1 < argc && !strcmp(argv[i], "-b")) {
+      bw = atoi(argv[++i]);
+    } else if(i + 1 < argc && !strcmp(argv[i], "-x")) {
+      etx = atoi(argv[++i]);
+    } else if(i + 1 < argc && !strcmp(argv[i], "-m")) {
+      mode = atoi(argv[++i]);
+    } else if(i + 1 < argc && !strcmp(argv[i], "-r")) {
+      reachable = atoi(argv[++i]);
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if(i >= argc) {
+    usage(argv[0]);
+  }
+
+  master = posix_openpt(O_RDWR | O_NOCTTY);
+  if(master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+    perror("pty");
+    return 1;
+  }
+
+  gettimeofday(&start, NULL);
+  pid = fork();
+  if(pid < 0) {
+    perror("fork");
+    return 1;
+  }
+  if(pid == 0) {
+    setsid();
+    slave = open(ptsname(master), O_RDWR);
+    if(slave < 0) {
+      perror("open pty");
+      _exit(1);
+    }
+    /* serial line carries binary frames, no translation or echo */
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    dup2(slave, STDIN_FILENO);
+    dup2(slave, STDOUT_FILENO);
+    close(slave);
+    close(master);
+    execvp(argv[i], &argv[i]);
+    perror("exec");
+    _exit(1);
+  }
+
+  /* read returns error (EIO) when mote program closes its side of pty */
+  while((len = read(master, buf, sizeof(buf))) > 0 || (len < 0 && errno == EINTR)) {
+    for(i = 0; i < len; i++) {
+      input_byte(buf[i]);
+    }
+  }
+  waitpid(pid, &status, 0);
+  gettimeofday(&end, NULL);
+
+  seconds = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+  fprintf(stderr, "peer: serial bytes %lu in %.3f s, frames %lu, route questions %lu\n",
+          serial_bytes, seconds, frames, questions);
+  fprintf(stderr, "peer: wifi packets %lu, serial bytes per packet %.1f\n",
+          packets, packets ? (double)packet_bytes / packets : 0.0);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+/*---------------------------------------------------------------------------*/
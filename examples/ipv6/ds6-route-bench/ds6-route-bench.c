@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+/**
+ * \file
+ *         Benchmark of the routing table on native platform. Routes of
+ *         mixed prefix lengths are added and removed at random, every
+ *         lookup is checked against a linear longest prefix match over
+ *         the route list. Then the table is filled and the cost of
+ *         uip_ds6_route_lookup() is reported to stderr.
+ *
+ *         ./ds6-route-bench.native [-n <lookups>] [-c <operations>]
+ *
+ *         "make bench" runs it for several table sizes, with and
+ *         without the prefix index.
+ */
+
+#include "contiki.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-ds6-route.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NEXTHOPS 8
+
+extern int contiki_argc;
+extern char **contiki_argv;
+
+static unsigned long lookups = 1000000;
+static unsigned long operations = 20000;
+
+static uip_ipaddr_t nexthops[NEXTHOPS];
+
+/*---------------------------------------------------------------------------*/
+PROCESS(ds6_route_bench_process, "Routing table benchmark");
+AUTOSTART_PROCESSES(&ds6_route_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+/* Next hops are link-local neighbors with made up link-layer addresses */
+static void
+add_nexthops(void)
+{
+  uip_lladdr_t lladdr;
+  int i;
+
+  for(i = 0; i < NEXTHOPS; i++) {
+    memset(&lladdr, 0, sizeof(lladdr));
+    lladdr.addr[sizeof(lladdr.addr) - 1] = i + 1;
+    uip_ip6addr(&nexthops[i], 0xfe80, 0, 0, 0, 0, 0, 0, i + 1);
+    uip_ds6_nbr_add(&nexthops[i], &lladdr, 1, NBR_REACHABLE,
+                    NBR_TABLE_REASON_UNDEFINED, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Destinations of a site with 16 subnets of 16 bit host ids, so host,
+   subnet and site routes overlap */
+static void
+random_addr(uip_ipaddr_t *addr)
+{
+  /* uip_ip6addr() evaluates its arguments more than once */
+  uint16_t subnet = random_rand() % 16;
+  uint16_t host = random_rand() % 1024;
+
+  uip_ip6addr(addr, 0xfd00, 0, 0, subnet, 0, 0, 0, host);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+random_length(void)
+{
+  static const uint8_t lengths[] = { 128, 128, 128, 128, 64, 64, 60, 48 };
+
+  return lengths[random_rand() % sizeof(lengths)];
+}
+/*---------------------------------------------------------------------------*/
+static void
+add_random_route(void)
+{
+  uip_ipaddr_t addr;
+
+  random_addr(&addr);
+  uip_ds6_route_add(&addr, random_length(),
+                    &nexthops[random_rand() % NEXTHOPS]);
+}
+/*---------------------------------------------------------------------------*/
+/* Longest prefix match as the route lookup did it without the index */
+static uip_ds6_route_t *
+linear_lookup(uip_ipaddr_t *addr)
+{
+  uip_ds6_route_t *r, *found = NULL;
+
+  for(r = uip_ds6_route_head(); r != NULL; r = uip_ds6_route_next(r)) {
+    if((found == NULL || r->length > found->length) &&
+       uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
+      found = r;
+    }
+  }
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+check(void)
+{
+  uip_ipaddr_t addr;
+  uip_ds6_route_t *r, *found;
+  unsigned long i, mismatches = 0;
+
+  for(i = 0; i < operations; i++) {
+    if(random_rand() % 4 != 0) {
+      add_random_route();
+    } else {
+      /* Prefixes are hit by addresses below them */
+      random_addr(&addr);
+      uip_ds6_route_rm(linear_lookup(&addr));
+    }
+    /* Routes to the same prefix may both be in the table, any of them
+       is the longest match */
+    random_addr(&addr);
+    r = linear_lookup(&addr);
+    found = uip_ds6_route_lookup(&addr);
+    if(found != r && (found == NULL || r == NULL ||
+                      found->length != r->length ||
+                      !uip_ipaddr_prefixcmp(&addr, &found->ipaddr,
+                                            found->length))) {
+      mismatches++;
+    }
+  }
+  return mismatches;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(ds6_route_bench_process, ev, data)
+{
+  static uip_ipaddr_t addrs[256];
+  uip_ds6_route_t *r;
+  unsigned long long start, elapsed;
+  unsigned long i, found, mismatches;
+
+  PROCESS_BEGIN();
+
+  for(i = 1; i + 1 < contiki_argc; i += 2) {
+    if(!strcmp(contiki_argv[i], "-n")) {
+      lookups = strtoul(contiki_argv[i + 1], NULL, 10);
+    } else if(!strcmp(contiki_argv[i], "-c")) {
+      operations = strtoul(contiki_argv[i + 1], NULL, 10);
+    }
+  }
+
+  random_init(1);
+  add_nexthops();
+
+  mismatches = check();
+  if(mismatches > 0) {
+    fprintf(stderr, "ds6-route-bench: %lu lookups differ from linear match\n",
+            mismatches);
+    exit(1);
+  }
+
+  while(uip_ds6_route_num_routes() < UIP_DS6_ROUTE_NB) {
+    add_random_route();
+  }
+  /* Half of the destinations are routed */
+  r = uip_ds6_route_head();
+  for(i = 0; i < sizeof(addrs) / sizeof(addrs[0]); i++) {
+    if(i % 2 == 0) {
+      uip_ipaddr_copy(&addrs[i], &r->ipaddr);
+      r = uip_ds6_route_next(r) != NULL ? uip_ds6_route_next(r) :
+        uip_ds6_route_head();
+    } else {
+      random_addr(&addrs[i]);
+    }
+  }
+
+  found = 0;
+  start = now_ns();
+  for(i = 0; i < lookups; i++) {
+    if(uip_ds6_route_lookup(&addrs[i % (sizeof(addrs) / sizeof(addrs[0]))])) {
+      found++;
+    }
+  }
+  elapsed = now_ns() - start;
+
+  fprintf(stderr, "ds6-route-bench: %4d routes index %d %7.1f ns/lookup (%lu found)\n",
+          UIP_DS6_ROUTE_NB, UIP_DS6_ROUTE_WITH_INDEX,
+          (double)elapsed / lookups, found);
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+/**
+ * \file
+ *         Benchmark of downward forwarding at a non-storing RPL root on
+ *         native platform. Builds a tree of RPL_NS_LINK_NUM nodes with
+ *         the given fanout in the root's node table and reports the
+ *         cost of rpl_update_header(), i.e. of looking up the
+ *         destination and inserting the source routing header, to
+ *         stderr. Before measuring, nodes are moved to new parents
+ *         between packets; a checksum of all generated headers is
+ *         printed, it must not depend on the configuration.
+ *
+ *         ./rpl-ns-bench.native [-n <packets>] [-f <fanout>]
+ *
+ *         "make bench" runs it for several network sizes, with and
+ *         without the hash index and the source route cache.
+ */
+
+#include "contiki.h"
+#include "net/ip/uip.h"
+#include "net/rpl/rpl-private.h"
+#include "lib/crc32.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define UIP_IP_BUF ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+
+#define PAYLOAD_LEN 32
+
+extern int contiki_argc;
+extern char **contiki_argv;
+
+static unsigned long packets = 1000000;
+static int fanout = 4;
+static rpl_dag_t *dag;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(rpl_ns_bench_process, "RPL non-storing root benchmark");
+AUTOSTART_PROCESSES(&rpl_ns_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+/* Node 0 is the root, all nodes share the prefix of the DAG */
+static void
+make_addr(uip_ipaddr_t *addr, unsigned node)
+{
+  uip_ip6addr(addr, 0xfd00, 0, 0, 0, 0x0212, 0x4b00, 0, node);
+}
+/*---------------------------------------------------------------------------*/
+static int
+set_parent(unsigned node, unsigned parent)
+{
+  uip_ipaddr_t child_addr, parent_addr;
+
+  make_addr(&child_addr, node);
+  make_addr(&parent_addr, parent);
+  return rpl_ns_update_node(dag, &child_addr, &parent_addr, 0xffff) != NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* A UDP packet from the root, as the application would hand it to IP */
+static int
+send_to(unsigned node)
+{
+  memset(UIP_IP_BUF, 0, UIP_IPH_LEN + UIP_UDPH_LEN + PAYLOAD_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = uip_ds6_if.cur_hop_limit;
+  UIP_IP_BUF->len[1] = UIP_UDPH_LEN + PAYLOAD_LEN;
+  memcpy(&UIP_IP_BUF->srcipaddr, &dag->dag_id, sizeof(uip_ipaddr_t));
+  make_addr(&UIP_IP_BUF->destipaddr, node);
+  uip_len = UIP_IPH_LEN + UIP_UDPH_LEN + PAYLOAD_LEN;
+  uip_ext_len = 0;
+
+  return rpl_update_header();
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+churn(void)
+{
+  uint32_t crc = 0;
+  unsigned node;
+  int i;
+
+  for(i = 0; i < 16 * RPL_NS_LINK_NUM; i++) {
+    /* Lower numbered parents keep the tree free of loops */
+    if(i % 4 == 0) {
+      node = 1 + random_rand() % (RPL_NS_LINK_NUM - 1);
+      set_parent(node, random_rand() % node);
+    }
+    if(!send_to(1 + random_rand() % (RPL_NS_LINK_NUM - 1))) {
+      fprintf(stderr, "rpl-ns-bench: no source route\n");
+      exit(1);
+    }
+    crc = crc32_data(&uip_buf[UIP_LLH_LEN], uip_len, crc);
+  }
+  return crc;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(rpl_ns_bench_process, ev, data)
+{
+  uip_ipaddr_t addr;
+  unsigned long long start, elapsed;
+  unsigned long i;
+  uint32_t crc;
+  int max_len = 0;
+
+  PROCESS_BEGIN();
+
+  for(i = 1; i + 1 < contiki_argc; i += 2) {
+    if(!strcmp(contiki_argv[i], "-n")) {
+      packets = strtoul(contiki_argv[i + 1], NULL, 10);
+    } else if(!strcmp(contiki_argv[i], "-f")) {
+      fanout = atoi(contiki_argv[i + 1]);
+    }
+  }
+
+  make_addr(&addr, 0);
+  dag = rpl_set_root(RPL_DEFAULT_INSTANCE, &addr);
+  if(dag == NULL || !rpl_set_prefix(dag, &addr, 64)) {
+    fprintf(stderr, "rpl-ns-bench: cannot become root\n");
+    exit(1);
+  }
+
+  for(i = 1; i < RPL_NS_LINK_NUM; i++) {
+    if(!set_parent(i, (i - 1) / fanout)) {
+      fprintf(stderr, "rpl-ns-bench: node table full\n");
+      exit(1);
+    }
+  }
+
+  crc = churn();
+
+  /* Back to the balanced tree */
+  for(i = 1; i < RPL_NS_LINK_NUM; i++) {
+    set_parent(i, (i - 1) / fanout);
+  }
+
+  start = now_ns();
+  for(i = 0; i < packets; i++) {
+    send_to(1 + i % (RPL_NS_LINK_NUM - 1));
+    if(uip_len > max_len) {
+      max_len = uip_len;
+    }
+  }
+  elapsed = now_ns() - start;
+
+  fprintf(stderr, "rpl-ns-bench: %4d nodes hash %d cache %2d %7.1f ns/packet (max %d bytes, check %08lx)\n",
+          RPL_NS_LINK_NUM, RPL_NS_WITH_HASH, RPL_NS_SRH_CACHE_SIZE,
+          (double)elapsed / packets, max_len, (unsigned long)crc);
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
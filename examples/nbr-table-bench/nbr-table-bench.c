@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+/**
+ * \file
+ *         Benchmark of neighbor table lookups on native platform. Fills
+ *         a table of NBR_TABLE_MAX_NEIGHBORS entries and reports the
+ *         cost of nbr_table_get_from_lladdr() for present and absent
+ *         addresses to stderr. Before measuring, the table is churned
+ *         with additions beyond its size, removals and address updates
+ *         and every lookup is checked against a walk of the table.
+ *
+ *         ./nbr-table-bench.native [-n <lookups>]
+ *
+ *         "make bench" runs it for several table sizes, with and
+ *         without the hash index.
+ */
+
+#include "contiki.h"
+#include "net/nbr-table.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+extern int contiki_argc;
+extern char **contiki_argv;
+
+struct bench_nbr {
+  uint32_t serial;
+};
+
+NBR_TABLE(struct bench_nbr, bench_table);
+
+static unsigned long lookups = 1000000;
+static uint32_t next_serial;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(nbr_table_bench_process, "Neighbor table benchmark");
+AUTOSTART_PROCESSES(&nbr_table_bench_process);
+/*---------------------------------------------------------------------------*/
+static unsigned long long
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+/* Addresses share a prefix as those of one vendor do */
+static void
+make_lladdr(linkaddr_t *lladdr, uint32_t serial)
+{
+  memset(lladdr, 0, sizeof(linkaddr_t));
+  lladdr->u8[0] = 0x00;
+  lladdr->u8[1] = 0x12;
+  lladdr->u8[2] = 0x4b;
+  lladdr->u8[LINKADDR_SIZE - 3] = serial >> 16;
+  lladdr->u8[LINKADDR_SIZE - 2] = serial >> 8;
+  lladdr->u8[LINKADDR_SIZE - 1] = serial;
+}
+/*---------------------------------------------------------------------------*/
+static struct bench_nbr *
+add(uint32_t serial)
+{
+  linkaddr_t lladdr;
+  struct bench_nbr *nbr;
+
+  make_lladdr(&lladdr, serial);
+  nbr = nbr_table_add_lladdr(bench_table, &lladdr, NBR_TABLE_REASON_UNDEFINED, NULL);
+  if(nbr != NULL) {
+    nbr->serial = serial;
+  }
+  return nbr;
+}
+/*---------------------------------------------------------------------------*/
+/* Every entry must be found under its address, and only there */
+static int
+check(void)
+{
+  struct bench_nbr *nbr;
+  linkaddr_t lladdr;
+  uint32_t serial;
+  int count = 0;
+
+  for(nbr = nbr_table_head(bench_table); nbr != NULL;
+      nbr = nbr_table_next(bench_table, nbr)) {
+    if(nbr_table_get_from_lladdr(bench_table, nbr_table_get_lladdr(bench_table, nbr)) != nbr) {
+      return 0;
+    }
+    make_lladdr(&lladdr, nbr->serial);
+    if(!linkaddr_cmp(&lladdr, nbr_table_get_lladdr(bench_table, nbr))) {
+      return 0;
+    }
+    count++;
+  }
+  for(serial = 0; serial < next_serial; serial++) {
+    make_lladdr(&lladdr, serial);
+    nbr = nbr_table_get_from_lladdr(bench_table, &lladdr);
+    if(nbr != NULL && nbr->serial != serial) {
+      return 0;
+    }
+    count -= nbr != NULL;
+  }
+  return count == 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+churn(void)
+{
+  struct bench_nbr *nbr;
+  linkaddr_t old_addr, new_addr;
+  int i;
+
+  for(i = 0; i < 4 * NBR_TABLE_MAX_NEIGHBORS; i++) {
+    switch(random_rand() % 4) {
+    case 0:
+    case 1:
+      /* Replaces the oldest entry when the table is full */
+      add(next_serial++);
+      break;
+    case 2:
+      nbr = nbr_table_head(bench_table);
+      if(nbr != NULL) {
+        nbr_table_remove(bench_table, nbr);
+      }
+      break;
+    case 3:
+      nbr = nbr_table_head(bench_table);
+      if(nbr != NULL) {
+        linkaddr_copy(&old_addr, nbr_table_get_lladdr(bench_table, nbr));
+        make_lladdr(&new_addr, next_serial);
+        if(nbr_table_update_lladdr(&old_addr, &new_addr, 0)) {
+          nbr->serial = next_serial++;
+        }
+      }
+      break;
+    }
+    if(!check()) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+measure(const char *name, uint32_t first_serial)
+{
+  unsigned long long start, elapsed;
+  unsigned long i, found = 0;
+  linkaddr_t lladdr;
+
+  start = now_ns();
+  for(i = 0; i < lookups; i++) {
+    make_lladdr(&lladdr, first_serial + i % NBR_TABLE_MAX_NEIGHBORS);
+    found += nbr_table_get_from_lladdr(bench_table, &lladdr) != NULL;
+  }
+  elapsed = now_ns() - start;
+
+  fprintf(stderr, "nbr-table-bench: %4d neighbors hash %d %-7s %7.1f ns/lookup (%lu found)\n",
+          NBR_TABLE_MAX_NEIGHBORS, NBR_TABLE_WITH_HASH, name,
+          (double)elapsed / lookups, found);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(nbr_table_bench_process, ev, data)
+{
+  int i;
+  uint32_t first_serial;
+
+  PROCESS_BEGIN();
+
+  for(i = 1; i + 1 < contiki_argc; i += 2) {
+    if(!strcmp(contiki_argv[i], "-n")) {
+      lookups = strtoul(contiki_argv[i + 1], NULL, 10);
+    }
+  }
+
+  nbr_table_register(bench_table, NULL);
+
+  if(!churn()) {
+    fprintf(stderr, "nbr-table-bench: lookup does not match table\n");
+    exit(1);
+  }
+
+  /* Fill the table with fresh entries, evicting the churned ones */
+  first_serial = next_serial;
+  for(i = 0; i < NBR_TABLE_MAX_NEIGHBORS; i++) {
+    add(next_serial++);
+  }
+  if(!check()) {
+    fprintf(stderr, "nbr-table-bench: lookup does not match table\n");
+    exit(1);
+  }
+
+  measure("present", first_serial);
+  measure("absent", next_serial);
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek.
+ * All rights reserved.
+ */
+
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+/* 802.15.4 extended addresses */
+#undef LINKADDR_CONF_SIZE
+#define LINKADDR_CONF_SIZE 8
+
+#endif /* PROJECT_CONF_H_ */
@@ -42,6 +42,12 @@
 #define RTIMERTICKS_TO_US(T)    (T)
 #define RTIMERTICKS_TO_US_64(T) (T)
 
+/* Tasks are executed from the main loop (rtimer_arch_check()), never
+   in the middle of a rtimer task queue update */
+#define RTIMER_ARCH_CRITICAL_STATE(state)
+#define RTIMER_ARCH_CRITICAL_ENTER(state)
+#define RTIMER_ARCH_CRITICAL_EXIT(state)
+
 rtimer_clock_t rtimer_arch_now(void);
 int rtimer_arch_check(void);
 int rtimer_arch_pending(void);
@@ -43,6 +43,11 @@ struct select_callback {
   void (* handle_fd)(fd_set *fdr, fd_set *fdw);
 };
 int select_set_callback(int fd, const struct select_callback *callback);
+/* Wakes the main loop from select(), safe to call from other threads
+   and signal handlers after process_poll() or process_post() */
+void select_wakeup(void);
+/* The rtimer signal handler wakes the main loop */
+#define RTIMER_ARCH_CONF_WAKEUP select_wakeup
 
 #define CC_CONF_REGISTER_ARGS          1
 #define CC_CONF_FUNCTION_POINTER_ARGS  1
@@ -263,6 +268,14 @@ typedef unsigned long clock_time_t;
 #define WWW_CONF_WEBPAGE_HEIGHT 17
 #endif /* PLATFORM_BUILD */
 
+/* Gateways checksum whole images and files, tables are cheap here */
+#ifndef CRC16_CONF_METHOD
+#define CRC16_CONF_METHOD CRC_METHOD_SLICE8
+#endif /* CRC16_CONF_METHOD */
+#ifndef CRC32_CONF_METHOD
+#define CRC32_CONF_METHOD CRC_METHOD_SLICE8
+#endif /* CRC32_CONF_METHOD */
+
 /* Not part of C99 but actually present */
 int strcasecmp(const char*, const char*);
 
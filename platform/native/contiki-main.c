@@ -45,6 +45,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/select.h>
 #include <errno.h>
 
@@ -78,9 +79,28 @@
 #define SELECT_MAX 8
 #endif
 
+/* Longest sleep in select() in milliseconds, a safety net for wake
+   sources that do not call select_wakeup() */
+#ifdef SELECT_CONF_MAX_TIMEOUT
+#define SELECT_MAX_TIMEOUT SELECT_CONF_MAX_TIMEOUT
+#else
+#define SELECT_MAX_TIMEOUT 1000
+#endif
+
+/* Interval in seconds of wakeups per second reports on stderr, 0
+   disables them */
+#ifdef SELECT_CONF_STATS
+#define SELECT_STATS SELECT_CONF_STATS
+#else
+#define SELECT_STATS 0
+#endif
+
 static const struct select_callback *select_callback[SELECT_MAX];
 static int select_max = 0;
 
+/* Self-pipe written by select_wakeup() */
+static int wakeup_fd[2] = { -1, -1 };
+
 SENSORS(&pir_sensor, &vib_sensor, &button_sensor);
 
 static uint8_t serial_id[] = {0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08};
@@ -140,6 +160,72 @@ const static struct select_callback stdin_fd = {
   stdin_set_fd, stdin_handle_fd
 };
 /*---------------------------------------------------------------------------*/
+void
+select_wakeup(void)
+{
+  char c = 0;
+
+  if(wakeup_fd[1] >= 0 && write(wakeup_fd[1], &c, 1) < 0) {
+    /* Pipe is full, the main loop wakes up anyway */
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+wakeup_set_fd(fd_set *rset, fd_set *wset)
+{
+  FD_SET(wakeup_fd[0], rset);
+  return 1;
+}
+static void
+wakeup_handle_fd(fd_set *rset, fd_set *wset)
+{
+  char buf[32];
+
+  if(FD_ISSET(wakeup_fd[0], rset)) {
+    while(read(wakeup_fd[0], buf, sizeof(buf)) > 0);
+  }
+}
+const static struct select_callback wakeup_fd_callback = {
+  wakeup_set_fd, wakeup_handle_fd
+};
+/*---------------------------------------------------------------------------*/
+static void
+wakeup_init(void)
+{
+  if(pipe(wakeup_fd) < 0) {
+    perror("pipe");
+    wakeup_fd[0] = wakeup_fd[1] = -1;
+    return;
+  }
+  fcntl(wakeup_fd[0], F_SETFL, fcntl(wakeup_fd[0], F_GETFL) | O_NONBLOCK);
+  fcntl(wakeup_fd[1], F_SETFL, fcntl(wakeup_fd[1], F_GETFL) | O_NONBLOCK);
+  if(!select_set_callback(wakeup_fd[0], &wakeup_fd_callback)) {
+    fprintf(stderr, "wakeup pipe fd %d is above SELECT_MAX\n", wakeup_fd[0]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Milliseconds until the next event timer expires, limited to
+ * SELECT_MAX_TIMEOUT.
+ */
+static clock_time_t
+select_timeout(void)
+{
+  clock_time_t left, now;
+
+  if(!etimer_pending()) {
+    return SELECT_MAX_TIMEOUT;
+  }
+  now = clock_time();
+  left = etimer_next_expiration_time() - now;
+  /* Expired timers are up to half of the clock range in the past */
+  if(left == 0 || left > ((clock_time_t)-1) / 2) {
+    return 0;
+  }
+  left = (left * 1000 + CLOCK_SECOND - 1) / CLOCK_SECOND;
+  return left > SELECT_MAX_TIMEOUT ? SELECT_MAX_TIMEOUT : left;
+}
+/*---------------------------------------------------------------------------*/
 static void
 set_rime_addr(void)
 {
@@ -250,6 +336,7 @@ main(int argc, char **argv)
   setvbuf(stdout, (char *)NULL, _IONBF, 0);
 
   select_set_callback(STDIN_FILENO, &stdin_fd);
+  wakeup_init();
   while(1) {
     fd_set fdr;
     fd_set fdw;
@@ -257,11 +344,18 @@ main(int argc, char **argv)
     int i;
     int retval;
     struct timeval tv;
+    clock_time_t timeout;
+#if SELECT_STATS
+    static unsigned long wakeups;
+    static clock_time_t report_time;
+#endif /* SELECT_STATS */
 
     retval = process_run();
 
-    tv.tv_sec = 0;
-    tv.tv_usec = retval ? 1 : 1000;
+    /* Sleep only when there is nothing to do until the next timer */
+    timeout = retval ? 0 : select_timeout();
+    tv.tv_sec = timeout / 1000;
+    tv.tv_usec = (timeout % 1000) * 1000;
 
     FD_ZERO(&fdr);
     FD_ZERO(&fdw);
@@ -273,6 +367,16 @@ main(int argc, char **argv)
     }
 
     retval = select(maxfd + 1, &fdr, &fdw, NULL, &tv);
+#if SELECT_STATS
+    if(timeout > 0) {
+      wakeups++;
+    }
+    if(clock_time() - report_time >= SELECT_STATS * CLOCK_SECOND) {
+      fprintf(stderr, "native: %lu wakeups/s\n", wakeups / SELECT_STATS);
+      wakeups = 0;
+      report_time = clock_time();
+    }
+#endif /* SELECT_STATS */
     if(retval < 0) {
       if(errno != EINTR) {
         perror("select");
@@ -286,7 +390,9 @@ main(int argc, char **argv)
       }
     }
 
-    etimer_request_poll();
+    if(etimer_pending() && select_timeout() == 0) {
+      etimer_request_poll();
+    }
 
 #if WITH_GUI
     if(console_resize()) {
@@ -34,4 +34,11 @@
 
 #define UNIT_TEST_PRINT_FUNCTION test_print_report
 
+/* Wide enough for test-rtimer not to depend on the time it runs */
+#define RTIMER_CONF_PRIORITY_GUARD (RTIMER_ARCH_SECOND / 100 + 1)
+
+/* Event priority classes and posting quota, see test-process */
+#define PROCESS_CONF_PRIORITIES 1
+#define PROCESS_CONF_QUOTA 8
+
 #endif /* !_PROJECT_CONF_H_ */
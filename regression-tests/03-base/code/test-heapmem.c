@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "lib/heapmem.h"
+#include "lib/random.h"
+
+PROCESS(test_process, "heapmem.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define SLOTS     32
+#define MAX_SIZE  200
+#define ROUNDS    5000
+
+/* Block header, see heapmem.h */
+#define HEADER    (2 * sizeof(void *))
+
+static uint8_t *ptr[SLOTS];
+static uint16_t len[SLOTS];
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+/* Every block is filled with its slot number, overlapping blocks
+   overwrite each other */
+static int
+intact(int i)
+{
+  uint16_t j;
+
+  for(j = 0; j < len[i]; j++) {
+    if(ptr[i][j] != i) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Payload, free space and headers of all blocks cover the heap */
+static int
+consistent(void)
+{
+  struct heapmem_stats stats;
+
+  heapmem_stats(&stats);
+  return stats.used + stats.free +
+    HEADER * (stats.free_blocks + stats.used_blocks - 1) == stats.size &&
+    stats.used <= stats.max_used && stats.largest_free <= stats.free;
+}
+
+UNIT_TEST_REGISTER(test_heapmem_basic, "Alloc / free");
+UNIT_TEST(test_heapmem_basic)
+{
+  struct heapmem_stats stats;
+  void *a, *b, *c;
+
+  UNIT_TEST_BEGIN();
+
+  heapmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.free_blocks == 1 && stats.free == stats.size);
+
+  UNIT_TEST_ASSERT(heapmem_alloc(0) == NULL);
+  UNIT_TEST_ASSERT(heapmem_alloc(stats.size + 1) == NULL);
+
+  a = heapmem_alloc(1);
+  b = heapmem_alloc(13);
+  c = heapmem_alloc(100);
+  UNIT_TEST_ASSERT(a != NULL && b != NULL && c != NULL);
+  UNIT_TEST_ASSERT(((uintptr_t)a | (uintptr_t)b | (uintptr_t)c) %
+                   sizeof(void *) == 0);
+  UNIT_TEST_ASSERT(consistent());
+
+  /* Freed neighbours are merged back into one block */
+  heapmem_free(b);
+  heapmem_free(a);
+  heapmem_free(c);
+  heapmem_free(NULL);
+  heapmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.free_blocks == 1 && stats.used_blocks == 0 &&
+                   stats.free == stats.size && stats.fragmentation == 0);
+
+  UNIT_TEST_END();
+}
+
+/*
+ * Blocks of random sizes are allocated and freed in random order. Live
+ * blocks must not overlap and the counters must add up, after freeing
+ * everything the heap is one block again.
+ */
+UNIT_TEST_REGISTER(test_heapmem_random, "Random alloc / free");
+UNIT_TEST(test_heapmem_random)
+{
+  struct heapmem_stats stats;
+  uint16_t round, allocated = 0;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  random_init(0x5eed);
+  memset(ptr, 0, sizeof(ptr));
+
+  for(round = 0; round < ROUNDS; round++) {
+    i = random_rand() % SLOTS;
+    if(ptr[i] == NULL) {
+      len[i] = 1 + random_rand() % MAX_SIZE;
+      ptr[i] = heapmem_alloc(len[i]);
+      if(ptr[i] != NULL) {
+        memset(ptr[i], i, len[i]);
+        allocated++;
+      }
+    } else {
+      UNIT_TEST_ASSERT(intact(i));
+      heapmem_free(ptr[i]);
+      ptr[i] = NULL;
+    }
+    if(round % 64 == 0) {
+      UNIT_TEST_ASSERT(consistent());
+    }
+  }
+  UNIT_TEST_ASSERT(allocated > ROUNDS / 4);
+
+  for(i = 0; i < SLOTS; i++) {
+    if(ptr[i] != NULL) {
+      UNIT_TEST_ASSERT(intact(i));
+      heapmem_free(ptr[i]);
+      ptr[i] = NULL;
+    }
+  }
+  heapmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.free_blocks == 1 && stats.used_blocks == 0 &&
+                   stats.free == stats.size);
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_heapmem_basic);
+  UNIT_TEST_RUN(test_heapmem_random);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
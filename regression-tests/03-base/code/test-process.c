@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+PROCESS(test_process, "process.c test");
+PROCESS(receiver_a, "receiver a");
+PROCESS(receiver_b, "receiver b");
+AUTOSTART_PROCESSES(&test_process);
+
+/*
+ * Events are posted from the test process, which then pauses. The
+ * CONTINUE event of the pause is posted last, so everything posted
+ * before it has been delivered when the test resumes. Receivers log
+ * event n as 'a' + n (receiver a) or 'A' + n (receiver b).
+ */
+#define LOG_SIZE 32
+
+static char delivered[LOG_SIZE + 1];
+static int ndelivered;
+static int posted_ok;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+static void
+record(char base, process_event_t ev)
+{
+  /* System events, e.g. broadcasts, are not logged */
+  if(ev < PROCESS_EVENT_NONE && ndelivered < LOG_SIZE) {
+    delivered[ndelivered++] = base + ev;
+    delivered[ndelivered] = '\0';
+  }
+}
+
+static void
+clear_log(void)
+{
+  ndelivered = 0;
+  delivered[0] = '\0';
+  posted_ok = 1;
+}
+
+static void
+post(struct process *p, process_event_t ev, unsigned char prio, int expected)
+{
+  if(process_post_prio(p, ev, NULL, prio) != expected) {
+    posted_ok = 0;
+  }
+}
+
+PROCESS_THREAD(receiver_a, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_YIELD();
+    record('a', ev);
+  }
+  PROCESS_END();
+}
+
+PROCESS_THREAD(receiver_b, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_YIELD();
+    record('A', ev);
+  }
+  PROCESS_END();
+}
+
+/* A high priority event goes ahead of normal events for other
+   processes, but not ahead of one for its own receiver */
+static void
+post_order(void)
+{
+  clear_log();
+  post(&receiver_a, 1, PROCESS_PRIO_NORMAL, PROCESS_ERR_OK);
+  post(&receiver_a, 2, PROCESS_PRIO_HIGH, PROCESS_ERR_OK);
+  post(&receiver_b, 3, PROCESS_PRIO_HIGH, PROCESS_ERR_OK);
+}
+
+UNIT_TEST_REGISTER(test_process_order, "Per-process order");
+UNIT_TEST(test_process_order)
+{
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(posted_ok);
+  UNIT_TEST_ASSERT(strcmp(delivered, "Dbc") == 0);
+
+  UNIT_TEST_END();
+}
+
+/* High priority events that do not fit into the high priority queue
+   are queued as normal events, in order */
+static void
+post_demotion(void)
+{
+  int i;
+
+  clear_log();
+  post(&receiver_a, 0, PROCESS_PRIO_NORMAL, PROCESS_ERR_OK);
+  for(i = 0; i < PROCESS_CONF_NUMEVENTS_HIGH + 2; i++) {
+    post(&receiver_b, 1 + i, PROCESS_PRIO_HIGH, PROCESS_ERR_OK);
+  }
+}
+
+UNIT_TEST_REGISTER(test_process_demotion, "Demotion");
+UNIT_TEST(test_process_demotion)
+{
+  char expected[LOG_SIZE + 1];
+  int i, n = 0;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < PROCESS_CONF_NUMEVENTS_HIGH; i++) {
+    expected[n++] = 'A' + 1 + i;
+  }
+  expected[n++] = 'a';
+  for(; i < PROCESS_CONF_NUMEVENTS_HIGH + 2; i++) {
+    expected[n++] = 'A' + 1 + i;
+  }
+  expected[n] = '\0';
+
+  UNIT_TEST_ASSERT(posted_ok);
+  UNIT_TEST_ASSERT(strcmp(delivered, expected) == 0);
+
+  UNIT_TEST_END();
+}
+
+/* Normal events to other processes are limited by the quota, high
+   priority events and events to the poster itself are not */
+static void
+post_quota(void)
+{
+  int i;
+
+  clear_log();
+  for(i = 0; i < PROCESS_QUOTA; i++) {
+    post(&receiver_a, i % 2, PROCESS_PRIO_NORMAL, PROCESS_ERR_OK);
+  }
+  post(&receiver_a, 2, PROCESS_PRIO_NORMAL, PROCESS_ERR_QUOTA);
+  post(&receiver_b, 2, PROCESS_PRIO_NORMAL, PROCESS_ERR_QUOTA);
+  post(&receiver_b, 3, PROCESS_PRIO_HIGH, PROCESS_ERR_OK);
+}
+
+UNIT_TEST_REGISTER(test_process_quota, "Quota");
+UNIT_TEST(test_process_quota)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(posted_ok);
+  UNIT_TEST_ASSERT(ndelivered == PROCESS_QUOTA + 1);
+  UNIT_TEST_ASSERT(delivered[0] == 'D');
+  for(i = 0; i < PROCESS_QUOTA; i++) {
+    UNIT_TEST_ASSERT(delivered[1 + i] == 'a' + i % 2);
+  }
+
+  /* Delivered events no longer count */
+  UNIT_TEST_ASSERT(process_post(&receiver_a, 4, NULL) == PROCESS_ERR_OK);
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  process_start(&receiver_a, NULL);
+  process_start(&receiver_b, NULL);
+  PROCESS_PAUSE();
+
+  post_order();
+  PROCESS_PAUSE();
+  UNIT_TEST_RUN(test_process_order);
+
+  post_demotion();
+  PROCESS_PAUSE();
+  UNIT_TEST_RUN(test_process_demotion);
+
+  post_quota();
+  PROCESS_PAUSE();
+  UNIT_TEST_RUN(test_process_quota);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
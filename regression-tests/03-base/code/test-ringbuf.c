@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "lib/ringbuf.h"
+
+PROCESS(test_process, "ringbuf.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define RB_SIZE 8
+
+static struct ringbuf rb;
+static uint8_t rb_data[RB_SIZE];
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+UNIT_TEST_REGISTER(test_ringbuf_put_get_n, "Put n / get n");
+UNIT_TEST(test_ringbuf_put_get_n)
+{
+  static const uint8_t in[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+  uint8_t out[10];
+  int ret;
+
+  UNIT_TEST_BEGIN();
+
+  ringbuf_init(&rb, rb_data, RB_SIZE);
+
+  /* One slot is always kept free */
+  ret = ringbuf_put_n(&rb, in, sizeof(in));
+  UNIT_TEST_ASSERT(ret == RB_SIZE - 1 && ringbuf_elements(&rb) == RB_SIZE - 1);
+
+  ret = ringbuf_get_n(&rb, out, 3);
+  UNIT_TEST_ASSERT(ret == 3 && memcmp(out, in, 3) == 0);
+
+  /* Wraps around the end of the array */
+  ret = ringbuf_put_n(&rb, in + 7, 3);
+  UNIT_TEST_ASSERT(ret == 3 && rb.put_ptr == 2);
+
+  ret = ringbuf_get_n(&rb, out, sizeof(out));
+  UNIT_TEST_ASSERT(ret == RB_SIZE - 1 && memcmp(out, in + 3, RB_SIZE - 1) == 0);
+
+  ret = ringbuf_get_n(&rb, out, sizeof(out));
+  UNIT_TEST_ASSERT(ret == 0 && ringbuf_get(&rb) == -1);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_ringbuf_peek_commit, "Peek / commit");
+UNIT_TEST(test_ringbuf_peek_commit)
+{
+  uint8_t *span;
+  const uint8_t *rspan;
+  int ret;
+
+  UNIT_TEST_BEGIN();
+
+  ringbuf_init(&rb, rb_data, RB_SIZE);
+
+  /* Empty buffer offers all but one slot */
+  ret = ringbuf_peek_put(&rb, &span);
+  UNIT_TEST_ASSERT(ret == RB_SIZE - 1 && span == &rb_data[0]);
+
+  /* Nothing is visible before the commit */
+  memset(span, 0xaa, 6);
+  UNIT_TEST_ASSERT(ringbuf_elements(&rb) == 0 &&
+                   ringbuf_peek_get(&rb, &rspan) == 0);
+  ringbuf_commit_put(&rb, 6);
+  UNIT_TEST_ASSERT(ringbuf_elements(&rb) == 6);
+
+  ret = ringbuf_peek_get(&rb, &rspan);
+  UNIT_TEST_ASSERT(ret == 6 && rspan == &rb_data[0] && rspan[5] == 0xaa);
+  ringbuf_commit_get(&rb, 5);
+
+  /* Free space is split by the end of the array */
+  ret = ringbuf_peek_put(&rb, &span);
+  UNIT_TEST_ASSERT(ret == 2 && span == &rb_data[6]);
+  span[0] = 0x11;
+  span[1] = 0x22;
+  ringbuf_commit_put(&rb, 2);
+  ret = ringbuf_peek_put(&rb, &span);
+  UNIT_TEST_ASSERT(ret == 4 && span == &rb_data[0]);
+  span[0] = 0x33;
+  ringbuf_commit_put(&rb, 1);
+
+  /* Data is split by the end of the array too */
+  ret = ringbuf_peek_get(&rb, &rspan);
+  UNIT_TEST_ASSERT(ret == 3 && rspan == &rb_data[5]);
+  UNIT_TEST_ASSERT(rspan[0] == 0xaa && rspan[1] == 0x11 && rspan[2] == 0x22);
+  ringbuf_commit_get(&rb, 3);
+  ret = ringbuf_peek_get(&rb, &rspan);
+  UNIT_TEST_ASSERT(ret == 1 && rspan[0] == 0x33);
+  ringbuf_commit_get(&rb, 1);
+  UNIT_TEST_ASSERT(ringbuf_elements(&rb) == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_ringbuf_mixed, "Mixed byte and bulk");
+UNIT_TEST(test_ringbuf_mixed)
+{
+  static const uint8_t in[] = { 'a', 'b', 'c' };
+  uint8_t out[4];
+  int ret;
+
+  UNIT_TEST_BEGIN();
+
+  ringbuf_init(&rb, rb_data, RB_SIZE);
+
+  ringbuf_put(&rb, 'x');
+  ringbuf_put_n(&rb, in, sizeof(in));
+  ringbuf_put(&rb, 'y');
+
+  UNIT_TEST_ASSERT(ringbuf_get(&rb) == 'x');
+  ret = ringbuf_get_n(&rb, out, sizeof(out));
+  UNIT_TEST_ASSERT(ret == 4 && memcmp(out, "abcy", 4) == 0);
+
+  UNIT_TEST_END();
+}
+
+/*
+ * Producer and consumer take turns with chunk sizes that do not divide
+ * the buffer size, as an interrupt handler and a process would. The
+ * consumer must see every byte once and in order.
+ */
+UNIT_TEST_REGISTER(test_ringbuf_spsc, "Producer / consumer stream");
+UNIT_TEST(test_ringbuf_spsc)
+{
+  uint8_t chunk[RB_SIZE];
+  uint8_t next_in = 0, next_out = 0;
+  uint16_t round;
+  int i, n, ret;
+
+  UNIT_TEST_BEGIN();
+
+  ringbuf_init(&rb, rb_data, RB_SIZE);
+
+  for(round = 0; round < 1000; round++) {
+    /* Producer */
+    n = 1 + (round * 7) % RB_SIZE;
+    for(i = 0; i < n; i++) {
+      chunk[i] = next_in + i;
+    }
+    ret = ringbuf_put_n(&rb, chunk, n);
+    UNIT_TEST_ASSERT(ret <= n && ringbuf_elements(&rb) <= RB_SIZE - 1);
+    next_in += ret;
+
+    /* Consumer */
+    n = 1 + (round * 5) % RB_SIZE;
+    ret = ringbuf_get_n(&rb, chunk, n);
+    for(i = 0; i < ret; i++) {
+      UNIT_TEST_ASSERT(chunk[i] == next_out);
+      next_out++;
+    }
+  }
+  UNIT_TEST_ASSERT((uint8_t)(next_in - next_out) == ringbuf_elements(&rb));
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_ringbuf_put_get_n);
+  UNIT_TEST_RUN(test_ringbuf_peek_commit);
+  UNIT_TEST_RUN(test_ringbuf_mixed);
+  UNIT_TEST_RUN(test_ringbuf_spsc);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -345,6 +345,53 @@ UNIT_TEST(test_ringbufindex_empty)
   UNIT_TEST_END();
 }
 
+UNIT_TEST_REGISTER(test_ringbufindex_bulk, "Bulk");
+UNIT_TEST(test_ringbufindex_bulk)
+{
+  uint8_t index;
+  int ret;
+
+  UNIT_TEST_BEGIN();
+
+  ringbufindex_init(&ri, 8);
+
+  /* Seven free elements, all contiguous */
+  ret = ringbufindex_peek_put_n(&ri, &index);
+  UNIT_TEST_ASSERT(ret == 7 && index == 0);
+
+  /* Put more than fits; nothing is added */
+  ret = ringbufindex_put_n(&ri, 8);
+  UNIT_TEST_ASSERT(ret == 0 && ri.put_ptr == 0);
+
+  ret = ringbufindex_put_n(&ri, 6);
+  UNIT_TEST_ASSERT(ret == 1 && ringbufindex_elements(&ri) == 6);
+
+  /* Get more than stored; nothing is removed */
+  ret = ringbufindex_get_n(&ri, 7);
+  UNIT_TEST_ASSERT(ret == 0 && ri.get_ptr == 0);
+
+  ret = ringbufindex_get_n(&ri, 5);
+  UNIT_TEST_ASSERT(ret == 1 && ri.get_ptr == 5);
+
+  /* Free space wraps; only the part up to the end is contiguous */
+  ret = ringbufindex_peek_put_n(&ri, &index);
+  UNIT_TEST_ASSERT(ret == 2 && index == 6);
+  ret = ringbufindex_put_n(&ri, 4);
+  UNIT_TEST_ASSERT(ret == 1 && ri.put_ptr == 2);
+
+  /* Stored elements wrap as well */
+  ret = ringbufindex_peek_get_n(&ri, &index);
+  UNIT_TEST_ASSERT(ret == 3 && index == 5);
+  ret = ringbufindex_get_n(&ri, 3);
+  UNIT_TEST_ASSERT(ret == 1 && ri.get_ptr == 0);
+  ret = ringbufindex_peek_get_n(&ri, &index);
+  UNIT_TEST_ASSERT(ret == 2 && index == 0);
+  ret = ringbufindex_get_n(&ri, 2);
+  UNIT_TEST_ASSERT(ret == 1 && ringbufindex_empty(&ri));
+
+  UNIT_TEST_END();
+}
+
 PROCESS_THREAD(test_process, ev, data)
 {
   PROCESS_BEGIN();
@@ -360,6 +407,7 @@ PROCESS_THREAD(test_process, ev, data)
   UNIT_TEST_RUN(test_ringbufindex_elements);
   UNIT_TEST_RUN(test_ringbufindex_full);
   UNIT_TEST_RUN(test_ringbufindex_empty);
+  UNIT_TEST_RUN(test_ringbufindex_bulk);
 
   printf("=check-me= DONE\n");
   PROCESS_END();
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "sys/rtimer.h"
+
+#ifdef CONTIKI_TARGET_NATIVE
+#include <signal.h>
+#endif /* CONTIKI_TARGET_NATIVE */
+
+PROCESS(test_process, "rtimer.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+/*
+ * Tasks are dispatched by calling rtimer_run_next() directly, the rtimer
+ * interrupt is kept from running them. Tasks posted in the past are due,
+ * tasks posted in the future are not.
+ */
+#define PAST(n) (RTIMER_NOW() - 3 * RTIMER_PRIORITY_GUARD + (n))
+#define FUTURE  (RTIMER_NOW() + 3 * RTIMER_PRIORITY_GUARD)
+
+#define NTASKS (RTIMER_MAX_DISPATCH + 2)
+
+static struct rtimer tasks[NTASKS];
+static char order[2 * NTASKS + 1];
+static int executed;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+static void
+callback(struct rtimer *t, void *ptr)
+{
+  order[executed++] = 'a' + (t - tasks);
+  order[executed] = '\0';
+}
+
+static int
+post(int i, rtimer_clock_t time)
+{
+  return rtimer_set(&tasks[i], time, 0, callback, NULL);
+}
+
+/* Executes all due tasks, returns the number of rtimer_run_next() calls */
+static int
+run_all(void)
+{
+  int calls, before;
+
+  for(calls = 0; ; calls++) {
+    before = executed;
+    rtimer_run_next();
+    if(executed == before) {
+      return calls;
+    }
+  }
+}
+
+static void
+reset(void)
+{
+  int i;
+
+  for(i = 0; i < NTASKS; i++) {
+    post(i, PAST(0));
+    rtimer_set_priority(&tasks[i], RTIMER_PRIORITY_NORMAL);
+  }
+  run_all();
+  executed = 0;
+  order[0] = '\0';
+}
+
+UNIT_TEST_REGISTER(test_rtimer_order, "Queue order");
+UNIT_TEST(test_rtimer_order)
+{
+  UNIT_TEST_BEGIN();
+
+  reset();
+
+  UNIT_TEST_ASSERT(post(0, PAST(3)) == RTIMER_OK);
+  UNIT_TEST_ASSERT(post(1, PAST(1)) == RTIMER_OK);
+  UNIT_TEST_ASSERT(post(2, PAST(2)) == RTIMER_OK);
+  /* Tasks due at the same time keep the order they were posted in */
+  UNIT_TEST_ASSERT(post(3, PAST(4)) == RTIMER_OK);
+  UNIT_TEST_ASSERT(post(4, PAST(4)) == RTIMER_OK);
+
+  run_all();
+  UNIT_TEST_ASSERT(strcmp(order, "bcade") == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_rtimer_not_due, "Tasks not due");
+UNIT_TEST(test_rtimer_not_due)
+{
+  UNIT_TEST_BEGIN();
+
+  reset();
+
+  /* A stale interrupt does not execute a task moved later */
+  post(0, PAST(0));
+  post(0, FUTURE);
+  rtimer_run_next();
+  UNIT_TEST_ASSERT(executed == 0);
+
+  /* Due tasks are executed, the later one stays queued */
+  post(1, PAST(0));
+  rtimer_run_next();
+  UNIT_TEST_ASSERT(strcmp(order, "b") == 0);
+
+  /* Moving the queued task executes it once */
+  post(0, PAST(0));
+  run_all();
+  UNIT_TEST_ASSERT(strcmp(order, "ba") == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_rtimer_priority, "Priority window");
+UNIT_TEST(test_rtimer_priority)
+{
+  UNIT_TEST_BEGIN();
+
+  reset();
+
+  /* A high priority task goes first when due close to a normal one */
+  rtimer_set_priority(&tasks[1], RTIMER_PRIORITY_HIGH);
+  post(0, PAST(0));
+  post(1, PAST(RTIMER_PRIORITY_GUARD));
+  run_all();
+  UNIT_TEST_ASSERT(strcmp(order, "ba") == 0);
+
+  /* A normal task waits for a high priority task which is not due yet */
+  post(0, RTIMER_NOW() - RTIMER_PRIORITY_GUARD / 2);
+  post(1, RTIMER_NOW() + RTIMER_PRIORITY_GUARD / 2);
+  rtimer_run_next();
+  UNIT_TEST_ASSERT(strcmp(order, "ba") == 0);
+
+  /* but not for one due later than the window */
+  post(1, FUTURE);
+  run_all();
+  UNIT_TEST_ASSERT(strcmp(order, "baa") == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_rtimer_dispatch_cap, "Dispatch cap");
+UNIT_TEST(test_rtimer_dispatch_cap)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  reset();
+
+  for(i = 0; i < NTASKS; i++) {
+    post(i, PAST(i));
+  }
+  rtimer_run_next();
+  UNIT_TEST_ASSERT(executed == RTIMER_MAX_DISPATCH);
+  rtimer_run_next();
+  UNIT_TEST_ASSERT(executed == NTASKS);
+  UNIT_TEST_ASSERT(strncmp(order, "abcdefghij", NTASKS) == 0);
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+#ifdef CONTIKI_TARGET_NATIVE
+  sigset_t mask;
+#endif /* CONTIKI_TARGET_NATIVE */
+
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+#ifdef CONTIKI_TARGET_NATIVE
+  /* The rtimer signal must not dispatch tasks during the tests */
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGALRM);
+  sigprocmask(SIG_BLOCK, &mask, NULL);
+#endif /* CONTIKI_TARGET_NATIVE */
+
+  UNIT_TEST_RUN(test_rtimer_order);
+  UNIT_TEST_RUN(test_rtimer_not_due);
+  UNIT_TEST_RUN(test_rtimer_priority);
+  UNIT_TEST_RUN(test_rtimer_dispatch_cap);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
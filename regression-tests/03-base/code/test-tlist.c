@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2017, Tomas Hermanek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "lib/tlist.h"
+
+PROCESS(test_process, "tlist.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* Every test runs on a singly and a doubly linked list, items are
+   named by letters */
+struct item {
+  struct item *next;
+  struct item *prev;
+  char id;
+};
+
+#define NITEMS 8
+
+static struct item items[NITEMS];
+
+TLIST(tl);
+DLIST(dl);
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+static struct item *
+item(char id)
+{
+  return &items[id - 'a'];
+}
+
+/* Initializes list and all items, the items are not on any list */
+static void
+reset(tlist_t l)
+{
+  int i;
+
+  memset(items, 0, sizeof(items));
+  for(i = 0; i < NITEMS; i++) {
+    items[i].id = 'a' + i;
+  }
+  tlist_init(l);
+}
+
+static void
+fill(tlist_t l, const char *ids)
+{
+  for(; *ids != '\0'; ids++) {
+    tlist_add(l, item(*ids));
+  }
+}
+
+/* Walks the list forward and checks items, previous items, length
+   and tail against expected */
+static int
+check(tlist_t l, const char *expected)
+{
+  struct item *i, *p = NULL;
+  int k, n = strlen(expected);
+
+  if(tlist_length(l) != n) {
+    return 0;
+  }
+  for(i = tlist_head(l), k = 0; k < n; i = tlist_item_next(i), k++) {
+    if(i == NULL || i->id != expected[k] || tlist_item_prev(l, i) != p) {
+      return 0;
+    }
+    p = i;
+  }
+  return i == NULL && tlist_tail(l) == p;
+}
+
+UNIT_TEST_REGISTER(test_tlist_ends, "Push / add / pop / chop");
+UNIT_TEST(test_tlist_ends)
+{
+  tlist_t lists[] = { tl, dl };
+  struct item *i;
+  int k;
+
+  UNIT_TEST_BEGIN();
+
+  for(k = 0; k < 2; k++) {
+    reset(lists[k]);
+    UNIT_TEST_ASSERT(check(lists[k], ""));
+    UNIT_TEST_ASSERT(tlist_pop(lists[k]) == NULL);
+    UNIT_TEST_ASSERT(tlist_chop(lists[k]) == NULL);
+
+    tlist_add(lists[k], item('b'));
+    tlist_add(lists[k], item('c'));
+    tlist_push(lists[k], item('a'));
+    UNIT_TEST_ASSERT(check(lists[k], "abc"));
+
+    i = tlist_pop(lists[k]);
+    UNIT_TEST_ASSERT(i == item('a') && i->next == NULL);
+    UNIT_TEST_ASSERT(check(lists[k], "bc"));
+
+    i = tlist_chop(lists[k]);
+    UNIT_TEST_ASSERT(i == item('c') && i->next == NULL && i->prev == NULL);
+    UNIT_TEST_ASSERT(check(lists[k], "b"));
+
+    /* The only item is both head and tail */
+    UNIT_TEST_ASSERT(tlist_chop(lists[k]) == item('b'));
+    UNIT_TEST_ASSERT(check(lists[k], ""));
+
+    tlist_push(lists[k], item('d'));
+    tlist_add(lists[k], item('e'));
+    UNIT_TEST_ASSERT(check(lists[k], "de"));
+    UNIT_TEST_ASSERT(tlist_pop(lists[k]) == item('d'));
+    UNIT_TEST_ASSERT(tlist_pop(lists[k]) == item('e'));
+    UNIT_TEST_ASSERT(check(lists[k], ""));
+  }
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_tlist_remove, "Remove");
+UNIT_TEST(test_tlist_remove)
+{
+  tlist_t lists[] = { tl, dl };
+  int k;
+
+  UNIT_TEST_BEGIN();
+
+  for(k = 0; k < 2; k++) {
+    reset(lists[k]);
+
+    /* Removing from an empty list does nothing */
+    tlist_remove(lists[k], item('a'));
+    UNIT_TEST_ASSERT(check(lists[k], ""));
+
+    fill(lists[k], "abcde");
+    tlist_remove(lists[k], item('a'));
+    UNIT_TEST_ASSERT(check(lists[k], "bcde"));
+    tlist_remove(lists[k], item('e'));
+    UNIT_TEST_ASSERT(check(lists[k], "bcd"));
+    tlist_remove(lists[k], item('c'));
+    UNIT_TEST_ASSERT(check(lists[k], "bd"));
+    UNIT_TEST_ASSERT(item('c')->next == NULL && item('c')->prev == NULL);
+
+    /* Items which are not on the list, one never was */
+    tlist_remove(lists[k], item('c'));
+    tlist_remove(lists[k], item('f'));
+    UNIT_TEST_ASSERT(check(lists[k], "bd"));
+
+    tlist_remove(lists[k], item('d'));
+    UNIT_TEST_ASSERT(check(lists[k], "b"));
+    tlist_remove(lists[k], item('b'));
+    UNIT_TEST_ASSERT(check(lists[k], ""));
+
+    fill(lists[k], "ca");
+    UNIT_TEST_ASSERT(check(lists[k], "ca"));
+  }
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_tlist_insert, "Insert");
+UNIT_TEST(test_tlist_insert)
+{
+  tlist_t lists[] = { tl, dl };
+  int k;
+
+  UNIT_TEST_BEGIN();
+
+  for(k = 0; k < 2; k++) {
+    reset(lists[k]);
+
+    /* Into an empty list */
+    tlist_insert(lists[k], NULL, item('c'));
+    UNIT_TEST_ASSERT(check(lists[k], "c"));
+
+    tlist_add(lists[k], item('e'));
+    tlist_insert(lists[k], item('c'), item('d'));
+    UNIT_TEST_ASSERT(check(lists[k], "cde"));
+
+    /* After the tail and before the head */
+    tlist_insert(lists[k], item('e'), item('f'));
+    UNIT_TEST_ASSERT(check(lists[k], "cdef"));
+    tlist_insert(lists[k], NULL, item('b'));
+    UNIT_TEST_ASSERT(check(lists[k], "bcdef"));
+
+    tlist_add(lists[k], item('g'));
+    UNIT_TEST_ASSERT(check(lists[k], "bcdefg"));
+    UNIT_TEST_ASSERT(tlist_chop(lists[k]) == item('g'));
+    UNIT_TEST_ASSERT(tlist_chop(lists[k]) == item('f'));
+    UNIT_TEST_ASSERT(check(lists[k], "bcde"));
+  }
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_tlist_ends);
+  UNIT_TEST_RUN(test_tlist_remove);
+  UNIT_TEST_RUN(test_tlist_insert);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}